@@ -0,0 +1,109 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <assert.h>
+#include "checkpoint.h"
+
+namespace tinyrv {
+
+// fixed-size bit set stored in 64-bit words
+class BitVector {
+public:
+  BitVector(uint32_t size = 0)
+    : size_(size)
+    , words_((size + 63) / 64, 0)
+  {}
+
+  uint32_t size() const {
+    return size_;
+  }
+
+  uint32_t num_words() const {
+    return words_.size();
+  }
+
+  uint64_t word(uint32_t index) const {
+    return words_[index];
+  }
+
+  bool test(uint32_t index) const {
+    assert(index < size_);
+    return (words_[index / 64] >> (index % 64)) & 0x1;
+  }
+
+  void set(uint32_t index) {
+    assert(index < size_);
+    words_[index / 64] |= (1ull << (index % 64));
+  }
+
+  void reset(uint32_t index) {
+    assert(index < size_);
+    words_[index / 64] &= ~(1ull << (index % 64));
+  }
+
+  void clear() {
+    for (auto& word : words_) {
+      word = 0;
+    }
+  }
+
+  bool any() const {
+    for (auto word : words_) {
+      if (word)
+        return true;
+    }
+    return false;
+  }
+
+  // first set bit at or after index, size() if none
+  uint32_t find_next(uint32_t index) const {
+    return find_next(index, size_, [&](uint32_t w) { return words_[w]; });
+  }
+
+  // first index in [index, end) whose bit is set in the word returned
+  // by get(w), used to search the intersection of several vectors
+  template <typename Get>
+  static uint32_t find_next(uint32_t index, uint32_t end, const Get& get) {
+    if (index >= end)
+      return end;
+    uint32_t w = index / 64;
+    uint64_t bits = get(w) & (~0ull << (index % 64));
+    for (uint32_t n = (end + 63) / 64;;) {
+      if (bits) {
+        uint32_t found = w * 64 + __builtin_ctzll(bits);
+        return (found < end) ? found : end;
+      }
+      if (++w == n)
+        return end;
+      bits = get(w);
+    }
+  }
+
+  friend CheckpointWriter& operator<<(CheckpointWriter& ckpt, const BitVector& value) {
+    return ckpt << value.words_;
+  }
+
+  friend CheckpointReader& operator>>(CheckpointReader& ckpt, BitVector& value) {
+    return ckpt >> value.words_;
+  }
+
+private:
+  uint32_t size_;
+  std::vector<uint64_t> words_;
+};
+
+}
@@ -0,0 +1,185 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <queue>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <type_traits>
+
+// Raw binary checkpoint streams.
+// Plain data is copied as is; containers are written as a count followed
+// by their elements. Types holding pointers provide their own overloads,
+// shared objects are written once and referenced by id afterwards.
+
+class CheckpointWriter {
+public:
+  CheckpointWriter(std::ostream& os) : os_(os) {}
+
+  void write(const void* data, uint64_t size) {
+    os_.write(static_cast<const char*>(data), size);
+  }
+
+  bool good() const {
+    return os_.good();
+  }
+
+  // id of a shared object, first is set on its first occurrence
+  uint64_t share_id(const void* ptr, bool* first) {
+    auto it = shared_.find(ptr);
+    *first = (it == shared_.end());
+    if (*first) {
+      it = shared_.emplace(ptr, shared_.size()).first;
+    }
+    return it->second;
+  }
+
+private:
+  std::ostream& os_;
+  std::unordered_map<const void*, uint64_t> shared_;
+};
+
+class CheckpointReader {
+public:
+  CheckpointReader(std::istream& is) : is_(is) {}
+
+  void read(void* data, uint64_t size) {
+    is_.read(static_cast<char*>(data), size);
+  }
+
+  bool good() const {
+    return is_.good();
+  }
+
+  // shared object slot for an id
+  std::shared_ptr<void>& shared(uint64_t id) {
+    return shared_[id];
+  }
+
+private:
+  std::istream& is_;
+  std::unordered_map<uint64_t, std::shared_ptr<void>> shared_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+typename std::enable_if<std::is_trivially_copyable<T>::value, CheckpointWriter&>::type
+operator<<(CheckpointWriter& ckpt, const T& value) {
+  ckpt.write(&value, sizeof(T));
+  return ckpt;
+}
+
+template <typename T>
+typename std::enable_if<std::is_trivially_copyable<T>::value, CheckpointReader&>::type
+operator>>(CheckpointReader& ckpt, T& value) {
+  ckpt.read(&value, sizeof(T));
+  return ckpt;
+}
+
+template <typename A, typename B>
+CheckpointWriter& operator<<(CheckpointWriter& ckpt, const std::pair<A, B>& value) {
+  return ckpt << value.first << value.second;
+}
+
+template <typename A, typename B>
+CheckpointReader& operator>>(CheckpointReader& ckpt, std::pair<A, B>& value) {
+  return ckpt >> value.first >> value.second;
+}
+
+inline CheckpointWriter& operator<<(CheckpointWriter& ckpt, const std::string& value) {
+  ckpt << uint64_t(value.size());
+  ckpt.write(value.data(), value.size());
+  return ckpt;
+}
+
+inline CheckpointReader& operator>>(CheckpointReader& ckpt, std::string& value) {
+  uint64_t size = 0;
+  ckpt >> size;
+  value.resize(size);
+  if (size != 0) {
+    ckpt.read(&value[0], size);
+  }
+  return ckpt;
+}
+
+template <typename T>
+CheckpointWriter& operator<<(CheckpointWriter& ckpt, const std::vector<T>& value) {
+  ckpt << uint64_t(value.size());
+  for (auto& element : value) {
+    ckpt << element;
+  }
+  return ckpt;
+}
+
+template <typename T>
+CheckpointReader& operator>>(CheckpointReader& ckpt, std::vector<T>& value) {
+  uint64_t size = 0;
+  ckpt >> size;
+  value.resize(size);
+  for (auto& element : value) {
+    ckpt >> element;
+  }
+  return ckpt;
+}
+
+template <typename T>
+CheckpointWriter& operator<<(CheckpointWriter& ckpt, const std::deque<T>& value) {
+  ckpt << uint64_t(value.size());
+  for (auto& element : value) {
+    ckpt << element;
+  }
+  return ckpt;
+}
+
+template <typename T>
+CheckpointReader& operator>>(CheckpointReader& ckpt, std::deque<T>& value) {
+  uint64_t size = 0;
+  ckpt >> size;
+  value.resize(size);
+  for (auto& element : value) {
+    ckpt >> element;
+  }
+  return ckpt;
+}
+
+template <typename T>
+CheckpointWriter& operator<<(CheckpointWriter& ckpt, const std::queue<T>& value) {
+  auto copy(value);
+  ckpt << uint64_t(copy.size());
+  while (!copy.empty()) {
+    ckpt << copy.front();
+    copy.pop();
+  }
+  return ckpt;
+}
+
+template <typename T>
+CheckpointReader& operator>>(CheckpointReader& ckpt, std::queue<T>& value) {
+  uint64_t size = 0;
+  ckpt >> size;
+  value = std::queue<T>();
+  for (uint64_t i = 0; i < size; ++i) {
+    T element;
+    ckpt >> element;
+    value.push(element);
+  }
+  return ckpt;
+}
@@ -16,7 +16,8 @@
 
 #include <memory>
 #include <iostream>
-#include <queue>
+#include <deque>
+#include <vector>
 #include <util.h>
 
 namespace tinyrv {
@@ -24,66 +25,84 @@ namespace tinyrv {
 template <typename T>
 class FiFoReg : public SimObject<FiFoReg<T>> {
 public:
+  // Pipeline latch holding up to depth entries.
+  // Several entries can be pushed and popped in the same cycle, pushes
+  // become visible on the next tick and popped entries stay readable
+  // through references until then.
   FiFoReg(const SimContext& ctx, const char* name, uint32_t depth = 1)
     : SimObject<FiFoReg<T>>(ctx, name)
     , depth_(depth)
-    , push_pending_(false)
-    , pop_pending_(false)
+    , pop_count_(0)
   {
     assert(depth > 0);
   }
 
   ~FiFoReg() {}
 
+  // entries left to read this cycle
+  uint32_t size() const {
+    return buffer_.size() - pop_count_;
+  }
+
   bool empty() const {
-    return (buffer_.empty() && !push_pending_)
-        || (buffer_.size() == 1 && pop_pending_);
+    return (this->size() == 0);
   }
 
   bool full() const {
-    return (buffer_.size() == depth_ && !pop_pending_)
-        || (buffer_.size() == (depth_-1) && push_pending_);
+    return (this->size() + push_data_.size()) >= depth_;
+  }
+
+  uint32_t depth() const {
+    return depth_;
   }
 
+  // oldest entry not yet popped
   const T& data() const {
-    assert(!buffer_.empty());
-    return buffer_.front();
+    assert(!this->empty());
+    return buffer_.at(pop_count_);
   }
 
   void push(const T& data) {
     assert(!full());
-    push_pending_ = true;
-    push_data_ = data;
+    push_data_.push_back(data);
   }
 
   void pop() {
     assert(!empty());
-    pop_pending_ = true;
+    ++pop_count_;
   }
 
   void reset() {
-    buffer_ = std::queue<T>();
-    push_pending_ = false;
-    pop_pending_ = false;
+    buffer_.clear();
+    push_data_.clear();
+    pop_count_ = 0;
+  }
+
+  void save(CheckpointWriter& ckpt) const {
+    ckpt << buffer_ << pop_count_ << push_data_;
+  }
+
+  void restore(CheckpointReader& ckpt) {
+    ckpt >> buffer_ >> pop_count_ >> push_data_;
+  }
+
+  uint64_t idle_cycles() const {
+    return (pop_count_ != 0 || !push_data_.empty()) ? 0 : UINT64_MAX;
   }
 
   void tick() {
-    if (pop_pending_ && !buffer_.empty()) {
-      buffer_.pop();
-      pop_pending_ = false;
-    }
-    if (push_pending_ && buffer_.size() < depth_) {
-      buffer_.push(push_data_);
-      push_pending_ = false;
+    buffer_.erase(buffer_.begin(), buffer_.begin() + pop_count_);
+    pop_count_ = 0;
+    for (auto& data : push_data_) {
+      buffer_.push_back(data);
     }
+    push_data_.clear();
   }
 
 protected:
   uint32_t depth_;
-  std::queue<T> buffer_;
-  bool push_pending_;
-  bool pop_pending_;
-  T push_data_;
+  std::deque<T> buffer_;
+  uint32_t pop_count_;
+  std::vector<T> push_data_;
 };
-
 }
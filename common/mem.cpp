@@ -208,6 +208,8 @@ void RAM::clear() {
   for (auto& page : pages_) {
     delete[] page.second;
   }
+  pages_.clear();
+  last_page_ = nullptr;
 }
 
 uint64_t RAM::size() const {
@@ -259,6 +261,34 @@ void RAM::write(const void* data, uint64_t addr, uint64_t size) {
   }
 }
 
+void RAM::save(CheckpointWriter& ckpt) const {
+  uint32_t page_size = 1 << page_bits_;
+  ckpt << page_bits_ << uint64_t(pages_.size());
+  for (auto& page : pages_) {
+    ckpt << page.first;
+    ckpt.write(page.second, page_size);
+  }
+}
+
+void RAM::restore(CheckpointReader& ckpt) {
+  uint32_t page_bits = 0;
+  uint64_t num_pages = 0;
+  ckpt >> page_bits >> num_pages;
+  if (page_bits != page_bits_) {
+    std::cout << "error: checkpoint page size mismatch" << std::endl;
+    std::abort();
+  }
+  this->clear();
+  uint32_t page_size = 1 << page_bits_;
+  for (uint64_t i = 0; i < num_pages; ++i) {
+    uint64_t page_index = 0;
+    ckpt >> page_index;
+    uint8_t *ptr = new uint8_t[page_size];
+    ckpt.read(ptr, page_size);
+    pages_.emplace(page_index, ptr);
+  }
+}
+
 void RAM::loadBinImage(const char* filename, uint64_t destination) {
   std::ifstream ifs(filename);
   if (!ifs) {
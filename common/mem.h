@@ -17,6 +17,7 @@
 #include <vector>
 #include <unordered_map>
 #include <cstdint>
+#include "checkpoint.h"
 
 namespace tinyrv {
 struct BadAddress {};
@@ -171,6 +172,10 @@ public:
   void loadBinImage(const char* filename, uint64_t destination);
   void loadHexImage(const char* filename);
 
+  // pages are written and read back as raw blocks
+  void save(CheckpointWriter& ckpt) const;
+  void restore(CheckpointReader& ckpt);
+
   uint8_t& operator[](uint64_t address) {
     return *this->get(address);
   }
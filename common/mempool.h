@@ -13,16 +13,29 @@
 
 #pragma once
 
-#include <stack>
+#include <cstdint>
+#include <new>
 
+// Free list is threaded through the released blocks themselves,
+// so recycling a block never touches the heap.
 template <typename T>
 class MemoryPool {
 public:  
-  MemoryPool(uint32_t max_size) : max_size_(max_size) {}
+  MemoryPool(uint32_t max_size)
+    : free_list_(nullptr)
+    , free_size_(0)
+    , max_size_(max_size)
+    , heap_allocs_(0)
+  {}
 
   MemoryPool(MemoryPool && other) 
-    : free_list_(std::move(other.free_list_)) 
-  {}
+    : free_list_(other.free_list_)
+    , free_size_(other.free_size_)
+    , max_size_(other.max_size_)
+    , heap_allocs_(other.heap_allocs_) {
+    other.free_list_ = nullptr;
+    other.free_size_ = 0;
+  }
 
   ~MemoryPool() {
     this->flush();
@@ -30,33 +43,51 @@ public:
 
   void* allocate() {
     void* mem;
-    if (!free_list_.empty()) {
-      auto entry = free_list_.top();
-      free_list_.pop();
+    if (free_list_ != nullptr) {
+      auto entry = free_list_;
+      free_list_ = entry->next;
+      --free_size_;
       mem = static_cast<void*>(entry);      
     } else {
-      mem = ::operator new(sizeof(T));
+      mem = ::operator new(sizeof(block_t));
+      ++heap_allocs_;
     }
     return mem;
   }
 
   void deallocate(void * object) {
-    if (free_list_.size() < max_size_) {
-      free_list_.push(static_cast<T*>(object));
+    if (free_size_ < max_size_) {
+      auto entry = static_cast<block_t*>(object);
+      entry->next = free_list_;
+      free_list_ = entry;
+      ++free_size_;
     } else {
       ::operator delete(object);
     }
   }
 
   void flush() {
-    while (!free_list_.empty()) {
-      auto entry = free_list_.top();
-      free_list_.pop();
+    while (free_list_ != nullptr) {
+      auto entry = free_list_;
+      free_list_ = entry->next;
       ::operator delete(entry);      
     }
+    free_size_ = 0;
+  }
+
+  // number of blocks obtained from the heap so far
+  uint64_t heap_allocs() const {
+    return heap_allocs_;
   }
 
 private:
-  std::stack<T*> free_list_;
+  union block_t {
+    block_t* next;
+    alignas(T) char data[sizeof(T)];
+  };
+
+  block_t* free_list_;
+  uint32_t free_size_;
   uint32_t max_size_;
+  uint64_t heap_allocs_;
 };
@@ -14,13 +14,17 @@
 #pragma once
 
 #include <functional>
+#include <algorithm>
 #include <iostream>
 #include <memory>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 #include <list>
 #include <queue>
 #include <assert.h>
 #include "mempool.h"
+#include "checkpoint.h"
 
 class SimObjectBase;
 
@@ -81,7 +85,7 @@ public:
   }
 
   const Pkt& front() const {
-    return queue_.front();
+    return queue_.front().pkt;
   }
 
   Pkt& front() {
@@ -89,7 +93,7 @@ public:
   }
 
   const Pkt& back() const {
-    return queue_.back();
+    return queue_.back().pkt;
   }
 
   Pkt& back() {
@@ -112,6 +116,15 @@ public:
     return queue_.front().cycles;
   }
 
+  // packets that arrived but were not consumed yet
+  void save(CheckpointWriter& ckpt) const {
+    ckpt << queue_;
+  }
+
+  void restore(CheckpointReader& ckpt) {
+    ckpt >> queue_;
+  }
+
 protected:
   struct timed_pkt_t {
     Pkt      pkt;
@@ -142,7 +155,8 @@ protected:
 
 class SimEventBase {
 public:
-  typedef std::shared_ptr<SimEventBase> Ptr;
+  // largest event object a pool slot can hold, inline callback included
+  static const size_t MaxSize = 128;
 
   virtual ~SimEventBase() {}
   
@@ -152,45 +166,66 @@ public:
     return cycles_;
   }
 
+  void* operator new(size_t size) {
+    assert(size <= MaxSize);
+    (void)size;
+    return allocator().allocate();
+  }
+
+  void operator delete(void* ptr) {
+    allocator().deallocate(ptr);
+  }
+
+  // number of event slots obtained from the heap so far
+  static uint64_t heap_allocs() {
+    return allocator().heap_allocs();
+  }
+
 protected:
-  SimEventBase(uint64_t cycles) : cycles_(cycles) {}
+  SimEventBase(uint64_t cycles) 
+    : cycles_(cycles)
+    , next_(nullptr) 
+  {}
 
   uint64_t cycles_;
+
+private:
+  struct slot_t {
+    alignas(16) char data[MaxSize];
+  };
+
+  // events of all types share one pool per host thread,
+  // keeping every released slot
+  static MemoryPool<slot_t>& allocator() {
+    static thread_local MemoryPool<slot_t> instance(UINT32_MAX);
+    return instance;
+  }
+
+  SimEventBase* next_;
+
+  friend class SimEventQueue;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
-template <typename Pkt>
+// the callback is stored by value inside the event,
+// so scheduling a lambda does not go through std::function
+template <typename Pkt, typename Func = std::function<void (const Pkt&)>>
 class SimCallEvent : public SimEventBase {
 public:
   void fire() const override {
     func_(pkt_);
   }
 
-  typedef std::function<void (const Pkt&)> Func;
-
   SimCallEvent(const Func& func, const Pkt& pkt, uint64_t cycles) 
     : SimEventBase(cycles)
     , func_(func)
     , pkt_(pkt)
   {}
 
-  void* operator new(size_t /*size*/) {
-    return allocator().allocate();
-  }
-
-  void operator delete(void* ptr) {
-    allocator().deallocate(ptr);
-  }
-
 protected:
   Func func_;
   Pkt  pkt_;
-
-  static MemoryPool<SimCallEvent<Pkt>>& allocator() {
-    static MemoryPool<SimCallEvent<Pkt>> instance(64);
-    return instance;
-  }
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -208,27 +243,156 @@ public:
     , pkt_(pkt)
   {}
 
-  void* operator new(size_t /*size*/) {
-    return allocator().allocate();
+protected:
+  const SimPort<Pkt>* port_; 
+  Pkt pkt_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Timing wheel of per-cycle buckets covering the next wheel_size cycles,
+// backed by an overflow heap for events scheduled further out.
+// Evaluating a cycle only visits the events due on that cycle.
+// Buckets are intrusive lists linked through the events, and the queue
+// owns the events it holds.
+class SimEventQueue {
+public:
+  SimEventQueue(uint32_t wheel_size = 256)
+    : buckets_(wheel_size, bucket_t{nullptr, nullptr})
+    , mask_(wheel_size - 1)
+    , size_(0)
+    , seq_(0)
+  {
+    assert(wheel_size != 0 && (wheel_size & mask_) == 0);
   }
 
-  void operator delete(void* ptr) {
-    allocator().deallocate(ptr);
+  ~SimEventQueue() {
+    this->clear();
   }
 
-protected:
-  const SimPort<Pkt>* port_; 
-  Pkt pkt_;
+  void push(SimEventBase* event, uint64_t cycles) {
+    auto delay = event->cycles() - cycles;
+    if (delay < buckets_.size()) {
+      // keep overflow events due earlier ahead of this one
+      this->migrate(cycles);
+      this->append(event);
+    } else {
+      overflow_.push({event->cycles(), seq_++, event});
+    }
+    ++size_;
+  }
+
+  // fire all events due on the given cycle
+  void fire(uint64_t cycles) {
+    this->migrate(cycles);
+    auto& bucket = buckets_[cycles & mask_];
+    // fired events can only schedule into later buckets
+    auto event = bucket.head;
+    bucket.head = nullptr;
+    bucket.tail = nullptr;
+    while (event != nullptr) {
+      assert(event->cycles() == cycles);
+      event->fire();
+      auto next = event->next_;
+      delete event;
+      event = next;
+      --size_;
+    }
+  }
 
-  static MemoryPool<SimPortEvent<Pkt>>& allocator() {
-    static MemoryPool<SimPortEvent<Pkt>> instance(64);
-    return instance;
+  void clear() {
+    for (auto& bucket : buckets_) {
+      auto event = bucket.head;
+      while (event != nullptr) {
+        auto next = event->next_;
+        delete event;
+        event = next;
+      }
+      bucket = bucket_t{nullptr, nullptr};
+    }
+    while (!overflow_.empty()) {
+      delete overflow_.top().event;
+      overflow_.pop();
+    }
+    size_ = 0;
+    seq_ = 0;
+  }
+
+  bool empty() const {
+    return (size_ == 0);
   }
+
+  size_t size() const {
+    return size_;
+  }
+
+  // firing cycle of the earliest pending event, UINT64_MAX if none
+  uint64_t next_cycle(uint64_t cycles) const {
+    for (uint64_t i = 0; i < buckets_.size(); ++i) {
+      auto event = buckets_[(cycles + i) & mask_].head;
+      if (event != nullptr)
+        return event->cycles();
+    }
+    if (!overflow_.empty())
+      return overflow_.top().cycles;
+    return UINT64_MAX;
+  }
+
+private:
+
+  struct bucket_t {
+    SimEventBase* head;
+    SimEventBase* tail;
+  };
+
+  struct overflow_entry_t {
+    uint64_t cycles;
+    uint64_t seq;
+    SimEventBase* event;
+
+    bool operator>(const overflow_entry_t& other) const {
+      return (cycles > other.cycles)
+          || (cycles == other.cycles && seq > other.seq);
+    }
+  };
+
+  typedef std::priority_queue<overflow_entry_t,
+                              std::vector<overflow_entry_t>,
+                              std::greater<overflow_entry_t>> overflow_queue_t;
+
+  void append(SimEventBase* event) {
+    auto& bucket = buckets_[event->cycles() & mask_];
+    event->next_ = nullptr;
+    if (bucket.tail) {
+      bucket.tail->next_ = event;
+    } else {
+      bucket.head = event;
+    }
+    bucket.tail = event;
+  }
+
+  // move overflow events that now fall within the wheel window
+  void migrate(uint64_t cycles) {
+    while (!overflow_.empty()
+        && (overflow_.top().cycles - cycles) < buckets_.size()) {
+      this->append(overflow_.top().event);
+      overflow_.pop();
+    }
+  }
+
+  std::vector<bucket_t> buckets_;
+  overflow_queue_t overflow_;
+  uint64_t mask_;
+  size_t   size_;
+  uint64_t seq_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
 class SimContext;
+class SimPlatform;
+class SimGroupSchedule;
+template <typename... Impls> class SimTypedSchedule;
 
 class SimObjectBase {
 public:
@@ -240,8 +404,19 @@ public:
     return name_;
   } 
 
+  SimPlatform& platform() const {
+    return *platform_;
+  }
+
 protected:
 
+  // statically bound entry points over a run of objects of the same type
+  struct Dispatch {
+    void (*tick)(SimObjectBase* const* objects, size_t count);
+    uint64_t (*idle_cycles)(SimObjectBase* const* objects, size_t count, uint64_t limit);
+    void (*skip)(SimObjectBase* const* objects, size_t count, uint64_t cycles);
+  };
+
   SimObjectBase(const SimContext& ctx, const char* name); 
 
 private:
@@ -250,9 +425,23 @@ private:
 
   virtual void do_tick() = 0;
 
+  virtual uint64_t do_idle_cycles() const = 0;
+
+  virtual void do_skip(uint64_t cycles) = 0;
+
+  virtual void do_save(CheckpointWriter& ckpt) const = 0;
+
+  virtual void do_restore(CheckpointReader& ckpt) = 0;
+
+  // one instance per concrete type, used by frozen schedules
+  virtual const Dispatch* dispatch() const = 0;
+
   std::string name_;
+  SimPlatform* platform_;
 
   friend class SimPlatform;
+  friend class SimGroupSchedule;
+  template <typename... Impls> friend class SimTypedSchedule;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -263,7 +452,7 @@ public:
   typedef std::shared_ptr<Impl> Ptr;
 
   template <typename... Args>
-  static Ptr Create(Args&&... args);
+  static Ptr Create(SimPlatform& platform, Args&&... args);
 
 protected:
 
@@ -271,6 +460,21 @@ protected:
     : SimObjectBase(ctx, name) 
   {}
 
+  // Number of upcoming ticks guaranteed to do no work other than advancing
+  // internal counters. Components that support fast-forward hide these
+  // defaults with their own implementation.
+  uint64_t idle_cycles() const {
+    return 0;
+  }
+
+  // advance internal counters over skipped idle cycles
+  void skip(uint64_t /*cycles*/) {}
+
+  // stateful components hide these to take part in checkpoints
+  void save(CheckpointWriter& /*ckpt*/) const {}
+
+  void restore(CheckpointReader& /*ckpt*/) {}
+
 private:
 
   const Impl* impl() const {
@@ -288,22 +492,241 @@ private:
   void do_tick() override {
     this->impl()->tick();
   }
+
+  uint64_t do_idle_cycles() const override {
+    return this->impl()->idle_cycles();
+  }
+
+  void do_skip(uint64_t cycles) override {
+    this->impl()->skip(cycles);
+  }
+
+  void do_save(CheckpointWriter& ckpt) const override {
+    this->impl()->save(ckpt);
+  }
+
+  void do_restore(CheckpointReader& ckpt) override {
+    this->impl()->restore(ckpt);
+  }
+
+  static void tick_all(SimObjectBase* const* objects, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+      static_cast<Impl*>(objects[i])->tick();
+    }
+  }
+
+  static uint64_t idle_cycles_all(SimObjectBase* const* objects, size_t count, uint64_t limit) {
+    for (size_t i = 0; i < count && limit != 0; ++i) {
+      limit = std::min<uint64_t>(limit, static_cast<const Impl*>(objects[i])->idle_cycles());
+    }
+    return limit;
+  }
+
+  static void skip_all(SimObjectBase* const* objects, size_t count, uint64_t cycles) {
+    for (size_t i = 0; i < count; ++i) {
+      static_cast<Impl*>(objects[i])->skip(cycles);
+    }
+  }
+
+  static const Dispatch* static_dispatch() {
+    static const Dispatch s_dispatch = {&SimObject::tick_all, &SimObject::idle_cycles_all, &SimObject::skip_all};
+    return &s_dispatch;
+  }
+
+  const Dispatch* dispatch() const override {
+    return SimObject::static_dispatch();
+  }
+
+  template <typename... Impls> friend class SimTypedSchedule;
 };
 
 class SimContext {
+public:
+  SimPlatform& platform() const {
+    return *platform_;
+  }
+
 private:    
-  SimContext() {}
+  SimContext(SimPlatform* platform) : platform_(platform) {}
+
+  SimPlatform* platform_;
   
   friend class SimPlatform;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// tick order of a frozen platform, fast-forward walks it too
+class SimSchedule {
+public:
+  virtual ~SimSchedule() {}
+
+  virtual void tick() = 0;
+
+  // idle cycles left, at most limit
+  virtual uint64_t idle_cycles(uint64_t limit) const = 0;
+
+  virtual void skip(uint64_t cycles) = 0;
+};
+
+// Consecutive objects of the same concrete type form a group that one
+// statically bound loop evaluates, costing an indirect call per group.
+class SimGroupSchedule : public SimSchedule {
+public:
+  void add(SimObjectBase* object) {
+    auto dispatch = object->dispatch();
+    if (groups_.empty() || groups_.back().dispatch != dispatch) {
+      groups_.push_back({dispatch, objects_.size(), 0});
+    }
+    objects_.push_back(object);
+    ++groups_.back().count;
+  }
+
+  void tick() override {
+    for (auto& group : groups_) {
+      group.dispatch->tick(&objects_[group.first], group.count);
+    }
+  }
+
+  uint64_t idle_cycles(uint64_t limit) const override {
+    for (auto& group : groups_) {
+      if (limit == 0)
+        break;
+      limit = group.dispatch->idle_cycles(&objects_[group.first], group.count, limit);
+    }
+    return limit;
+  }
+
+  void skip(uint64_t cycles) override {
+    for (auto& group : groups_) {
+      group.dispatch->skip(&objects_[group.first], group.count, cycles);
+    }
+  }
+
+private:
+  struct group_t {
+    const SimObjectBase::Dispatch* dispatch;
+    size_t first;
+    size_t count;
+  };
+
+  std::vector<SimObjectBase*> objects_;
+  std::vector<group_t> groups_;
+};
+
+// Objects of a fixed list of concrete types, kept in one array per type
+// and evaluated type after type through direct calls the compiler can
+// inline, costing a single indirect call per cycle.
+template <typename... Impls>
+class SimTypedSchedule : public SimSchedule {
+public:
+  SimTypedSchedule() : last_(0) {}
+
+  // false unless the object is one of Impls, in list order
+  bool add(SimObjectBase* object) {
+    return this->add_to<0>(object);
+  }
+
+  void tick() override {
+    this->tick_from<0>();
+  }
+
+  uint64_t idle_cycles(uint64_t limit) const override {
+    return this->idle_cycles_from<0>(limit);
+  }
+
+  void skip(uint64_t cycles) override {
+    this->skip_from<0>(cycles);
+  }
+
+private:
+  static const size_t NumTypes = sizeof...(Impls);
+
+  template <size_t I>
+  using impl_t = typename std::tuple_element<I, std::tuple<Impls...>>::type;
+
+  template <size_t I>
+  typename std::enable_if<(I < NumTypes), bool>::type add_to(SimObjectBase* object) {
+    if (object->dispatch() != SimObject<impl_t<I>>::static_dispatch())
+      return this->add_to<I + 1>(object);
+    if (I < last_)
+      return false;
+    last_ = I;
+    objects_[I].push_back(object);
+    return true;
+  }
+
+  template <size_t I>
+  typename std::enable_if<(I == NumTypes), bool>::type add_to(SimObjectBase*) {
+    return false;
+  }
+
+  template <size_t I>
+  typename std::enable_if<(I < NumTypes)>::type tick_from() {
+    auto& objects = objects_[I];
+    SimObject<impl_t<I>>::tick_all(objects.data(), objects.size());
+    this->tick_from<I + 1>();
+  }
+
+  template <size_t I>
+  typename std::enable_if<(I == NumTypes)>::type tick_from() {}
+
+  template <size_t I>
+  typename std::enable_if<(I < NumTypes), uint64_t>::type idle_cycles_from(uint64_t limit) const {
+    auto& objects = objects_[I];
+    limit = SimObject<impl_t<I>>::idle_cycles_all(objects.data(), objects.size(), limit);
+    return (limit != 0) ? this->idle_cycles_from<I + 1>(limit) : 0;
+  }
+
+  template <size_t I>
+  typename std::enable_if<(I == NumTypes), uint64_t>::type idle_cycles_from(uint64_t limit) const {
+    return limit;
+  }
+
+  template <size_t I>
+  typename std::enable_if<(I < NumTypes)>::type skip_from(uint64_t cycles) {
+    auto& objects = objects_[I];
+    SimObject<impl_t<I>>::skip_all(objects.data(), objects.size(), cycles);
+    this->skip_from<I + 1>(cycles);
+  }
+
+  template <size_t I>
+  typename std::enable_if<(I == NumTypes)>::type skip_from(uint64_t) {}
+
+  std::vector<SimObjectBase*> objects_[NumTypes];
+  size_t last_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 class SimPlatform {
 public:
-  static SimPlatform& instance() {
-    static SimPlatform s_inst;
-    return s_inst;
+  struct PerfStats {
+    uint64_t events;
+    uint64_t event_allocs;
+
+    PerfStats()
+      : events(0)
+      , event_allocs(0)
+    {}
+  };
+
+  SimPlatform() 
+    : cycles_(0)
+    , fast_forward_(false) 
+    , heap_allocs_base_(SimEventBase::heap_allocs())
+  {}
+
+  ~SimPlatform() {
+    this->clear();
+    if (current_ref() == this) {
+      current_ref() = nullptr;
+    }
+  }
+
+  // platform that last evaluated on the calling thread, used by the trace macros
+  static SimPlatform* current() {
+    return current_ref();
   }
 
   bool initialize() {
@@ -312,53 +735,93 @@ public:
   }
 
   void finalize() {
-    instance().clear();
+    this->clear();
   }
 
   template <typename Impl, typename... Args>
   typename SimObject<Impl>::Ptr create_object(Args&&... args) {
-    auto obj = std::make_shared<Impl>(SimContext{}, std::forward<Args>(args)...);
+    auto obj = std::make_shared<Impl>(SimContext{this}, std::forward<Args>(args)...);
     objects_.push_back(obj);
+    this->thaw();
     return obj;
   }
 
   void release_object(const SimObjectBase::Ptr& object) {
     objects_.remove(object);
+    this->thaw();
   }
 
-  template <typename Pkt>
-  void schedule(const typename SimCallEvent<Pkt>::Func& callback,
-                const Pkt& pkt, 
-                uint64_t delay) {    
+  // Flatten the object list into a contiguous schedule of same-type groups,
+  // preserving creation order, instead of a virtual call per object.
+  // Fast-forward scans the same schedule. Creating or releasing an object
+  // drops the schedule again.
+  void freeze() {
+    auto schedule = new SimGroupSchedule();
+    for (auto& object : objects_) {
+      schedule->add(object.get());
+    }
+    schedule_.reset(schedule);
+  }
+
+  // Freeze into a schedule of the given concrete types, evaluated with
+  // direct calls. The list names every object's exact type in creation
+  // order, types without objects are allowed; otherwise this falls back
+  // to freeze().
+  template <typename... Impls>
+  void freeze_typed() {
+    auto schedule = new SimTypedSchedule<Impls...>();
+    schedule_.reset(schedule);
+    for (auto& object : objects_) {
+      if (!schedule->add(object.get())) {
+        this->freeze();
+        return;
+      }
+    }
+  }
+
+  bool frozen() const {
+    return schedule_ != nullptr;
+  }
+
+  template <typename Pkt, typename Func>
+  void schedule(Func&& callback, const Pkt& pkt, uint64_t delay) {
+    typedef SimCallEvent<Pkt, typename std::decay<Func>::type> Event;
+    static_assert(sizeof(Event) <= SimEventBase::MaxSize, "event callback too large");
     assert(delay != 0);
-    auto evt = std::make_shared<SimCallEvent<Pkt>>(callback, pkt, cycles_ + delay);    
-    events_.emplace_back(evt);
+    events_.push(new Event(callback, pkt, cycles_ + delay), cycles_);
+    ++perf_stats_.events;
   }
 
   void reset() {
+    current_ref() = this;
     events_.clear();
     for (auto& object : objects_) {
       object->do_reset();
     }
     cycles_ = 0;
+    perf_stats_ = PerfStats();
+    heap_allocs_base_ = SimEventBase::heap_allocs();
+  }
+
+  // jump over idle cycles instead of ticking through them
+  void fast_forward(bool enable) {
+    fast_forward_ = enable;
   }
 
   void tick() {
-    // evaluate events
-    auto evt_it = events_.begin();
-    auto evt_it_end = events_.end();
-    while (evt_it != evt_it_end) {
-      auto& event = *evt_it;
-      if (cycles_ >= event->cycles()) {        
-        event->fire();
-        evt_it = events_.erase(evt_it);
-      } else {        
-        ++evt_it;
-      }
+    current_ref() = this;
+    if (fast_forward_) {
+      this->skip_idle();
     }
+    // evaluate events
+    events_.fire(cycles_);
     // evaluate components
-    for (auto& object : objects_) {
-      object->do_tick();
+    if (schedule_) {
+      schedule_->tick();
+    } else {
+      for (auto& object : objects_) {
+        object->do_tick();
+      }
     }
     // advance clock    
     ++cycles_;
@@ -368,29 +831,111 @@ public:
     return cycles_;
   }
 
+  size_t pending_events() const {
+    return events_.size();
+  }
+
+  // Save the clock and every object's state, in creation order.
+  // Events hold arbitrary callbacks and cannot be saved, so this
+  // fails unless the event queue is empty.
+  bool save(CheckpointWriter& ckpt) const {
+    if (!events_.empty())
+      return false;
+    ckpt << cycles_ << perf_stats_ << uint64_t(objects_.size());
+    for (auto& object : objects_) {
+      ckpt << object->name();
+      object->do_save(ckpt);
+    }
+    return ckpt.good();
+  }
+
+  // restore into an object graph built the same way as the saved one
+  bool restore(CheckpointReader& ckpt) {
+    current_ref() = this;
+    events_.clear();
+    uint64_t num_objects = 0;
+    ckpt >> cycles_ >> perf_stats_ >> num_objects;
+    heap_allocs_base_ = SimEventBase::heap_allocs();
+    if (num_objects != objects_.size())
+      return false;
+    for (auto& object : objects_) {
+      std::string name;
+      ckpt >> name;
+      if (name != object->name())
+        return false;
+      object->do_restore(ckpt);
+    }
+    return ckpt.good();
+  }
+
+  PerfStats perf_stats() const {
+    auto stats = perf_stats_;
+    // the event pool is shared by the platforms run on this thread
+    stats.event_allocs = SimEventBase::heap_allocs() - heap_allocs_base_;
+    return stats;
+  }
+
 private:
 
-  SimPlatform() : cycles_(0) {}
+  SimPlatform(const SimPlatform&) = delete;
+  SimPlatform& operator=(const SimPlatform&) = delete;
 
-  virtual ~SimPlatform() {
-    this->clear();
+  static SimPlatform*& current_ref() {
+    static thread_local SimPlatform* s_current = nullptr;
+    return s_current;
+  }
+
+  void skip_idle() {
+    uint64_t next = events_.next_cycle(cycles_);
+    uint64_t skip = (next != UINT64_MAX) ? (next - cycles_) : UINT64_MAX;
+    if (schedule_) {
+      skip = schedule_->idle_cycles(skip);
+    } else {
+      for (auto& object : objects_) {
+        if (skip == 0)
+          return;
+        skip = std::min(skip, object->do_idle_cycles());
+      }
+    }
+    // nothing left to wake the system up
+    if (skip == 0 || skip == UINT64_MAX)
+      return;
+    if (schedule_) {
+      schedule_->skip(skip);
+    } else {
+      for (auto& object : objects_) {
+        object->do_skip(skip);
+      }
+    }
+    cycles_ += skip;
+  }
+
+  void thaw() {
+    schedule_.reset();
   }
 
   void clear() {
+    this->thaw();
     objects_.clear();
     events_.clear();
   }
 
   template <typename Pkt>
   void schedule(const SimPort<Pkt>* port, const Pkt& pkt, uint64_t delay) {
+    typedef SimPortEvent<Pkt> Event;
+    static_assert(sizeof(Event) <= SimEventBase::MaxSize, "port packet too large");
     assert(delay != 0);
-    auto evt = SimEventBase::Ptr(new SimPortEvent<Pkt>(port, pkt, cycles_ + delay));
-    events_.emplace_back(evt);
+    events_.push(new Event(port, pkt, cycles_ + delay), cycles_);
+    ++perf_stats_.events;
   }
 
   std::list<SimObjectBase::Ptr> objects_;
-  std::list<SimEventBase::Ptr> events_;
+  std::unique_ptr<SimSchedule> schedule_;
+  SimEventQueue events_;
   uint64_t cycles_;
+  bool fast_forward_;
+  PerfStats perf_stats_;
+  uint64_t heap_allocs_base_;
 
   template <typename U> friend class SimPort;
   friend class SimObjectBase;
@@ -398,14 +943,15 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
-inline SimObjectBase::SimObjectBase(const SimContext&, const char* name) 
+inline SimObjectBase::SimObjectBase(const SimContext& ctx, const char* name) 
   : name_(name) 
+  , platform_(&ctx.platform())
 {}
 
 template <typename Impl>
 template <typename... Args>
-typename SimObject<Impl>::Ptr SimObject<Impl>::Create(Args&&... args) {
-  return SimPlatform::instance().create_object<Impl>(std::forward<Args>(args)...);
+typename SimObject<Impl>::Ptr SimObject<Impl>::Create(SimPlatform& platform, Args&&... args) {
+  return platform.create_object<Impl>(std::forward<Args>(args)...);
 }
 
 template <typename Pkt>
@@ -413,6 +959,6 @@ void SimPort<Pkt>::send(const Pkt& pkt, uint64_t delay) const {
   if (peer_ && !tx_cb_) {
     reinterpret_cast<const SimPort<Pkt>*>(peer_)->send(pkt, delay);    
   } else {
-    SimPlatform::instance().schedule(this, pkt, delay);
+    module_->platform().schedule(this, pkt, delay);
   } 
 }
@@ -45,6 +45,18 @@ public:
     data_next_ = init_;
   }
 
+  void save(CheckpointWriter& ckpt) const {
+    ckpt << data_ << data_next_;
+  }
+
+  void restore(CheckpointReader& ckpt) {
+    ckpt >> data_ >> data_next_;
+  }
+
+  uint64_t idle_cycles() const {
+    return (data_next_ == data_) ? UINT64_MAX : 0;
+  }
+
   void tick() {
     data_ = data_next_;
   }
@@ -0,0 +1,429 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <cmath>
+#include <assert.h>
+#include <util.h>
+#include "BPU.h"
+
+using namespace tinyrv;
+
+// largest power of two not above value, at least min_value,
+// budgets are bounded by BPRED_MAX_BUDGET
+static uint32_t pow2_fit(uint64_t value, uint32_t min_value) {
+  if (value < min_value)
+    return min_value;
+  assert(value <= (1u << 31));
+  return 1u << log2floor((uint32_t)value);
+}
+
+static void update_counter(uint8_t& counter, bool taken) {
+  if (taken) {
+    if (counter < 3)
+      ++counter;
+  } else {
+    if (counter > 0)
+      --counter;
+  }
+}
+
+BranchPredictor::Ptr BranchPredictor::Create(BPredType type, uint32_t budget) {
+  switch (type) {
+  case BPredType::BIMODAL:    return std::make_shared<Bimodal>(budget);
+  case BPredType::GSHARE:     return std::make_shared<GShare>(budget);
+  case BPredType::TAGE:       return std::make_shared<TAGE>(budget);
+  case BPredType::PERCEPTRON: return std::make_shared<Perceptron>(budget);
+  default:
+    return nullptr;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+Bimodal::Bimodal(uint32_t budget)
+  : counters_(pow2_fit(uint64_t(budget) * 8 / 2, 1), 1)
+{}
+
+bool Bimodal::predict(uint32_t PC, const BranchHistory& /*history*/, uint32_t /*pos*/) const {
+  return counters_[(PC >> 2) & (counters_.size() - 1)] >= 2;
+}
+
+void Bimodal::update(uint32_t PC, const BranchHistory& /*history*/, uint32_t /*pos*/, bool taken) {
+  update_counter(counters_[(PC >> 2) & (counters_.size() - 1)], taken);
+}
+
+uint64_t Bimodal::storage() const {
+  return counters_.size() * 2;
+}
+
+void Bimodal::save(CheckpointWriter& ckpt) const {
+  ckpt << counters_;
+}
+
+void Bimodal::restore(CheckpointReader& ckpt) {
+  ckpt >> counters_;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+GShare::GShare(uint32_t budget)
+  : counters_(pow2_fit(uint64_t(budget) * 8 / 2, 2), 1)
+  , history_bits_(log2floor(counters_.size()))
+{}
+
+uint32_t GShare::index(uint32_t PC, const BranchHistory& history, uint32_t pos) const {
+  uint32_t ghr = (uint32_t)history.recent(pos, history_bits_);
+  return ((PC >> 2) ^ ghr) & (counters_.size() - 1);
+}
+
+bool GShare::predict(uint32_t PC, const BranchHistory& history, uint32_t pos) const {
+  return counters_[this->index(PC, history, pos)] >= 2;
+}
+
+void GShare::update(uint32_t PC, const BranchHistory& history, uint32_t pos, bool taken) {
+  update_counter(counters_[this->index(PC, history, pos)], taken);
+}
+
+uint64_t GShare::storage() const {
+  return counters_.size() * 2;
+}
+
+void GShare::save(CheckpointWriter& ckpt) const {
+  ckpt << counters_;
+}
+
+void GShare::restore(CheckpointReader& ckpt) {
+  ckpt >> counters_;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TAGE::TAGE(uint32_t budget)
+  : tables_(TAGE_NUM_TABLES)
+  , lengths_(TAGE_NUM_TABLES)
+  , tag_bits_(TAGE_TAG_BITS)
+  , updates_(0) {
+  static_assert(TAGE_MAX_HISTORY < BranchHistory::Size, "invalid TAGE history");
+  // a quarter of the budget goes to the base table
+  uint64_t bits = uint64_t(budget) * 8;
+  base_.resize(pow2_fit(bits / 4 / 2, 2), 1);
+  uint64_t table_bits = (bits - base_.size() * 2) / TAGE_NUM_TABLES;
+  uint32_t entries = pow2_fit(table_bits / (3 + tag_bits_ + 2 + 1), 2);
+  index_bits_ = log2floor(entries);
+  for (uint32_t t = 0; t < TAGE_NUM_TABLES; ++t) {
+    tables_[t].resize(entries, entry_t{0, 0, 0, false});
+    double ratio = double(TAGE_MAX_HISTORY) / TAGE_MIN_HISTORY;
+    lengths_[t] = (uint32_t)(TAGE_MIN_HISTORY * std::pow(ratio, double(t) / (TAGE_NUM_TABLES - 1)) + 0.5);
+  }
+}
+
+void TAGE::lookup(uint32_t PC, const BranchHistory& history, uint32_t pos, lookup_t* result) const {
+  uint32_t pc = PC >> 2;
+  uint32_t index_mask = (1 << index_bits_) - 1;
+  uint32_t tag_mask = (1 << tag_bits_) - 1;
+  result->base_index = pc & (base_.size() - 1);
+  result->provider = -1;
+  result->alt = -1;
+  for (uint32_t t = 0; t < TAGE_NUM_TABLES; ++t) {
+    auto length = lengths_[t];
+    uint32_t index = pc ^ (pc >> index_bits_) ^ history.fold(pos, length, index_bits_);
+    uint32_t tag = pc ^ history.fold(pos, length, tag_bits_) ^ (history.fold(pos, length, tag_bits_ - 1) << 1);
+    result->index[t] = index & index_mask;
+    result->tag[t] = tag & tag_mask;
+  }
+  for (int t = TAGE_NUM_TABLES - 1; t >= 0; --t) {
+    auto& entry = tables_[t][result->index[t]];
+    if (!entry.valid || entry.tag != result->tag[t])
+      continue;
+    if (result->provider < 0) {
+      result->provider = t;
+    } else {
+      result->alt = t;
+      break;
+    }
+  }
+}
+
+bool TAGE::table_pred(const lookup_t& result, int table) const {
+  if (table < 0)
+    return base_[result.base_index] >= 2;
+  return tables_[table][result.index[table]].ctr >= 0;
+}
+
+bool TAGE::predict(uint32_t PC, const BranchHistory& history, uint32_t pos) const {
+  lookup_t result;
+  this->lookup(PC, history, pos, &result);
+  return this->table_pred(result, result.provider);
+}
+
+void TAGE::update(uint32_t PC, const BranchHistory& history, uint32_t pos, bool taken) {
+  lookup_t result;
+  this->lookup(PC, history, pos, &result);
+  int provider = result.provider;
+  bool pred = this->table_pred(result, provider);
+  bool alt_pred = this->table_pred(result, result.alt);
+
+  // on a misprediction, allocate an entry in a longer history table
+  if (pred != taken && provider < (TAGE_NUM_TABLES - 1)) {
+    bool allocated = false;
+    for (int t = provider + 1; t < TAGE_NUM_TABLES; ++t) {
+      auto& entry = tables_[t][result.index[t]];
+      if (entry.u == 0) {
+        entry = {int8_t(taken ? 0 : -1), result.tag[t], 0, true};
+        allocated = true;
+        break;
+      }
+    }
+    if (!allocated) {
+      for (int t = provider + 1; t < TAGE_NUM_TABLES; ++t) {
+        auto& entry = tables_[t][result.index[t]];
+        if (entry.u > 0)
+          --entry.u;
+      }
+    }
+  }
+
+  // train the provider
+  if (provider >= 0) {
+    auto& entry = tables_[provider][result.index[provider]];
+    if (taken) {
+      if (entry.ctr < 3)
+        ++entry.ctr;
+    } else {
+      if (entry.ctr > -4)
+        --entry.ctr;
+    }
+    if (pred != alt_pred) {
+      if (pred == taken) {
+        if (entry.u < 3)
+          ++entry.u;
+      } else {
+        if (entry.u > 0)
+          --entry.u;
+      }
+    }
+  } else {
+    update_counter(base_[result.base_index], taken);
+  }
+
+  // periodically age the useful counters
+  if ((++updates_ & ((256 * 1024) - 1)) == 0) {
+    for (auto& table : tables_) {
+      for (auto& entry : table) {
+        entry.u >>= 1;
+      }
+    }
+  }
+}
+
+uint64_t TAGE::storage() const {
+  return base_.size() * 2 + uint64_t(TAGE_NUM_TABLES) * (uint64_t(1) << index_bits_) * (3 + tag_bits_ + 2 + 1);
+}
+
+void TAGE::save(CheckpointWriter& ckpt) const {
+  ckpt << base_;
+  for (auto& table : tables_) {
+    ckpt << table;
+  }
+  ckpt << updates_;
+}
+
+void TAGE::restore(CheckpointReader& ckpt) {
+  ckpt >> base_;
+  for (auto& table : tables_) {
+    ckpt >> table;
+  }
+  ckpt >> updates_;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+Perceptron::Perceptron(uint32_t budget) {
+  // longer histories pay off with larger budgets
+  if (budget <= 512) {
+    history_bits_ = 8;
+  } else if (budget <= 1024) {
+    history_bits_ = 12;
+  } else if (budget <= 2048) {
+    history_bits_ = 22;
+  } else if (budget <= 4096) {
+    history_bits_ = 28;
+  } else if (budget <= 8192) {
+    history_bits_ = 34;
+  } else if (budget <= 16384) {
+    history_bits_ = 36;
+  } else {
+    history_bits_ = 59;
+  }
+  num_rows_ = pow2_fit(uint64_t(budget) * 8 / (8 * (history_bits_ + 1)), 1);
+  threshold_ = (int)(1.93 * history_bits_ + 14);
+  weights_.resize(num_rows_ * (history_bits_ + 1), 0);
+}
+
+int Perceptron::output(uint32_t PC, const BranchHistory& history, uint32_t pos) const {
+  auto w = &weights_[((PC >> 2) & (num_rows_ - 1)) * (history_bits_ + 1)];
+  int y = w[0];
+  for (uint32_t i = 0; i < history_bits_; ++i) {
+    y += history.bit(pos, i) ? w[i + 1] : -w[i + 1];
+  }
+  return y;
+}
+
+bool Perceptron::predict(uint32_t PC, const BranchHistory& history, uint32_t pos) const {
+  return this->output(PC, history, pos) >= 0;
+}
+
+void Perceptron::update(uint32_t PC, const BranchHistory& history, uint32_t pos, bool taken) {
+  int y = this->output(PC, history, pos);
+  if ((y >= 0) == taken && std::abs(y) > threshold_)
+    return;
+  auto w = &weights_[((PC >> 2) & (num_rows_ - 1)) * (history_bits_ + 1)];
+  auto train = [](int8_t& weight, bool agree) {
+    if (agree) {
+      if (weight < 127)
+        ++weight;
+    } else {
+      if (weight > -127)
+        --weight;
+    }
+  };
+  train(w[0], taken);
+  for (uint32_t i = 0; i < history_bits_; ++i) {
+    train(w[i + 1], history.bit(pos, i) == taken);
+  }
+}
+
+uint64_t Perceptron::storage() const {
+  return weights_.size() * 8;
+}
+
+void Perceptron::save(CheckpointWriter& ckpt) const {
+  ckpt << weights_;
+}
+
+void Perceptron::restore(CheckpointReader& ckpt) {
+  ckpt >> weights_;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ITTAGE::ITTAGE()
+  : tables_(ITTAGE_NUM_TABLES)
+  , lengths_(ITTAGE_NUM_TABLES)
+  , index_bits_(log2floor(ITTAGE_TABLE_SIZE))
+  , updates_(0) {
+  static_assert(ispow2(ITTAGE_TABLE_SIZE), "invalid ITTAGE table size");
+  static_assert(ITTAGE_MAX_HISTORY < BranchHistory::Size, "invalid ITTAGE history");
+  for (uint32_t t = 0; t < ITTAGE_NUM_TABLES; ++t) {
+    tables_[t].resize(ITTAGE_TABLE_SIZE, entry_t{0, 0, 0, 0});
+    double ratio = double(ITTAGE_MAX_HISTORY) / ITTAGE_MIN_HISTORY;
+    lengths_[t] = (uint32_t)(ITTAGE_MIN_HISTORY * std::pow(ratio, double(t) / (ITTAGE_NUM_TABLES - 1)) + 0.5);
+  }
+}
+
+void ITTAGE::lookup(uint32_t PC, const BranchHistory& history, uint32_t pos, lookup_t* result) const {
+  uint32_t pc = PC >> 2;
+  uint32_t index_mask = (1 << index_bits_) - 1;
+  uint32_t tag_mask = (1 << ITTAGE_TAG_BITS) - 1;
+  result->provider = -1;
+  for (uint32_t t = 0; t < ITTAGE_NUM_TABLES; ++t) {
+    auto length = lengths_[t];
+    uint32_t index = pc ^ (pc >> index_bits_) ^ history.fold(pos, length, index_bits_);
+    uint32_t tag = pc ^ history.fold(pos, length, ITTAGE_TAG_BITS) ^ (history.fold(pos, length, ITTAGE_TAG_BITS - 1) << 1);
+    result->index[t] = index & index_mask;
+    result->tag[t] = tag & tag_mask;
+  }
+  for (int t = ITTAGE_NUM_TABLES - 1; t >= 0; --t) {
+    auto& entry = tables_[t][result->index[t]];
+    if (entry.target != 0 && entry.tag == result->tag[t]) {
+      result->provider = t;
+      break;
+    }
+  }
+}
+
+bool ITTAGE::predict(uint32_t PC, const BranchHistory& history, uint32_t pos, uint32_t* target) const {
+  lookup_t result;
+  this->lookup(PC, history, pos, &result);
+  if (result.provider < 0)
+    return false;
+  *target = tables_[result.provider][result.index[result.provider]].target;
+  return true;
+}
+
+void ITTAGE::update(uint32_t PC, const BranchHistory& history, uint32_t pos, uint32_t target) {
+  lookup_t result;
+  this->lookup(PC, history, pos, &result);
+  int provider = result.provider;
+  bool correct = false;
+
+  // train the provider, replace its target once confidence runs out
+  if (provider >= 0) {
+    auto& entry = tables_[provider][result.index[provider]];
+    if (entry.target == target) {
+      correct = true;
+      if (entry.ctr < 3)
+        ++entry.ctr;
+      if (entry.u < 3)
+        ++entry.u;
+    } else if (entry.ctr > 0) {
+      --entry.ctr;
+    } else {
+      entry.target = target;
+    }
+  }
+
+  // on a misprediction, allocate an entry in a longer history table
+  if (!correct && provider < (ITTAGE_NUM_TABLES - 1)) {
+    bool allocated = false;
+    for (int t = provider + 1; t < ITTAGE_NUM_TABLES; ++t) {
+      auto& entry = tables_[t][result.index[t]];
+      if (entry.u == 0) {
+        entry = {result.tag[t], target, 0, 0};
+        allocated = true;
+        break;
+      }
+    }
+    if (!allocated) {
+      for (int t = provider + 1; t < ITTAGE_NUM_TABLES; ++t) {
+        auto& entry = tables_[t][result.index[t]];
+        if (entry.u > 0)
+          --entry.u;
+      }
+    }
+  }
+
+  // periodically age the useful counters
+  if ((++updates_ & ((64 * 1024) - 1)) == 0) {
+    for (auto& table : tables_) {
+      for (auto& entry : table) {
+        entry.u >>= 1;
+      }
+    }
+  }
+}
+
+void ITTAGE::save(CheckpointWriter& ckpt) const {
+  for (auto& table : tables_) {
+    ckpt << table;
+  }
+  ckpt << updates_;
+}
+
+void ITTAGE::restore(CheckpointReader& ckpt) {
+  for (auto& table : tables_) {
+    ckpt >> table;
+  }
+  ckpt >> updates_;
+}
@@ -0,0 +1,268 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <checkpoint.h>
+#include "types.h"
+
+namespace tinyrv {
+
+// speculative global branch history
+// Outcomes are kept in a circular buffer and a branch remembers the
+// position it saw at fetch: a squash rolls back to that position and
+// commit-time training reads the same bits the prediction used.
+class BranchHistory {
+public:
+  static const uint32_t Size = 1024;
+
+  BranchHistory() : bits_(Size, 0), pos_(0) {}
+
+  uint32_t pos() const {
+    return pos_;
+  }
+
+  void push(bool taken) {
+    bits_[++pos_ & (Size - 1)] = taken;
+  }
+
+  void restore(uint32_t pos) {
+    pos_ = pos;
+  }
+
+  // i-th most recent outcome at position pos
+  bool bit(uint32_t pos, uint32_t i) const {
+    return bits_[(pos - i) & (Size - 1)];
+  }
+
+  // last n outcomes at position pos, most recent in bit 0
+  uint64_t recent(uint32_t pos, uint32_t n) const {
+    uint64_t value = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+      value |= uint64_t(this->bit(pos, i)) << i;
+    }
+    return value;
+  }
+
+  // last n outcomes at position pos folded into width bits
+  uint32_t fold(uint32_t pos, uint32_t n, uint32_t width) const {
+    uint32_t value = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+      value ^= uint32_t(this->bit(pos, i)) << (i % width);
+    }
+    return value;
+  }
+
+  void save(CheckpointWriter& ckpt) const {
+    ckpt << bits_ << pos_;
+  }
+
+  void restore(CheckpointReader& ckpt) {
+    ckpt >> bits_ >> pos_;
+  }
+
+private:
+  std::vector<uint8_t> bits_;
+  uint32_t pos_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// conditional branch direction predictor
+// predict() runs at fetch, update() trains at commit with the
+// history position the branch saw at fetch.
+class BranchPredictor {
+public:
+  typedef std::shared_ptr<BranchPredictor> Ptr;
+
+  static Ptr Create(BPredType type, uint32_t budget);
+
+  virtual ~BranchPredictor() {}
+
+  virtual bool predict(uint32_t PC, const BranchHistory& history, uint32_t pos) const = 0;
+
+  virtual void update(uint32_t PC, const BranchHistory& history, uint32_t pos, bool taken) = 0;
+
+  // table storage in bits
+  virtual uint64_t storage() const = 0;
+
+  virtual void save(CheckpointWriter& ckpt) const = 0;
+
+  virtual void restore(CheckpointReader& ckpt) = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// 2-bit saturating counters indexed by PC
+class Bimodal : public BranchPredictor {
+public:
+  Bimodal(uint32_t budget);
+
+  bool predict(uint32_t PC, const BranchHistory& history, uint32_t pos) const override;
+
+  void update(uint32_t PC, const BranchHistory& history, uint32_t pos, bool taken) override;
+
+  uint64_t storage() const override;
+
+  void save(CheckpointWriter& ckpt) const override;
+
+  void restore(CheckpointReader& ckpt) override;
+
+private:
+  std::vector<uint8_t> counters_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// 2-bit saturating counters indexed by PC xor the global history
+class GShare : public BranchPredictor {
+public:
+  GShare(uint32_t budget);
+
+  bool predict(uint32_t PC, const BranchHistory& history, uint32_t pos) const override;
+
+  void update(uint32_t PC, const BranchHistory& history, uint32_t pos, bool taken) override;
+
+  uint64_t storage() const override;
+
+  void save(CheckpointWriter& ckpt) const override;
+
+  void restore(CheckpointReader& ckpt) override;
+
+private:
+  uint32_t index(uint32_t PC, const BranchHistory& history, uint32_t pos) const;
+
+  std::vector<uint8_t> counters_;
+  uint32_t history_bits_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// TAgged GEometric history length predictor
+// a bimodal base table backed by tagged tables indexed with geometrically
+// increasing history lengths, the longest matching table provides the prediction.
+class TAGE : public BranchPredictor {
+public:
+  TAGE(uint32_t budget);
+
+  bool predict(uint32_t PC, const BranchHistory& history, uint32_t pos) const override;
+
+  void update(uint32_t PC, const BranchHistory& history, uint32_t pos, bool taken) override;
+
+  uint64_t storage() const override;
+
+  void save(CheckpointWriter& ckpt) const override;
+
+  void restore(CheckpointReader& ckpt) override;
+
+private:
+
+  struct entry_t {
+    int8_t   ctr;   // 3-bit signed counter
+    uint16_t tag;
+    uint8_t  u;     // 2-bit useful counter
+    bool     valid; // allocated, a zero tag is a legal tag
+  };
+
+  struct lookup_t {
+    uint32_t base_index;
+    uint32_t index[TAGE_NUM_TABLES];
+    uint16_t tag[TAGE_NUM_TABLES];
+    int provider;   // longest matching table, -1 for the base table
+    int alt;        // next matching table, -1 for the base table
+  };
+
+  void lookup(uint32_t PC, const BranchHistory& history, uint32_t pos, lookup_t* result) const;
+
+  bool table_pred(const lookup_t& result, int table) const;
+
+  std::vector<uint8_t> base_;
+  std::vector<std::vector<entry_t>> tables_;
+  std::vector<uint32_t> lengths_;
+  uint32_t index_bits_;
+  uint32_t tag_bits_;
+  uint32_t updates_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// perceptron predictor
+// a table of weight vectors indexed by PC, the prediction is the sign of
+// the dot product of the weights with the global history.
+class Perceptron : public BranchPredictor {
+public:
+  Perceptron(uint32_t budget);
+
+  bool predict(uint32_t PC, const BranchHistory& history, uint32_t pos) const override;
+
+  void update(uint32_t PC, const BranchHistory& history, uint32_t pos, bool taken) override;
+
+  uint64_t storage() const override;
+
+  void save(CheckpointWriter& ckpt) const override;
+
+  void restore(CheckpointReader& ckpt) override;
+
+private:
+  int output(uint32_t PC, const BranchHistory& history, uint32_t pos) const;
+
+  std::vector<int8_t> weights_;
+  uint32_t history_bits_;
+  uint32_t num_rows_;
+  int threshold_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// ITTAGE indirect target predictor
+// tagged tables indexed with geometric history lengths hold jump targets,
+// the longest matching table provides the target. Without a match the
+// caller falls back to the BTB.
+class ITTAGE {
+public:
+  ITTAGE();
+
+  bool predict(uint32_t PC, const BranchHistory& history, uint32_t pos, uint32_t* target) const;
+
+  void update(uint32_t PC, const BranchHistory& history, uint32_t pos, uint32_t target);
+
+  void save(CheckpointWriter& ckpt) const;
+
+  void restore(CheckpointReader& ckpt);
+
+private:
+
+  struct entry_t {
+    uint16_t tag;
+    uint32_t target;
+    uint8_t  ctr;   // 2-bit confidence counter
+    uint8_t  u;     // 2-bit useful counter
+  };
+
+  struct lookup_t {
+    uint32_t index[ITTAGE_NUM_TABLES];
+    uint16_t tag[ITTAGE_NUM_TABLES];
+    int provider;   // longest matching table, -1 if none
+  };
+
+  void lookup(uint32_t PC, const BranchHistory& history, uint32_t pos, lookup_t* result) const;
+
+  std::vector<std::vector<entry_t>> tables_;
+  std::vector<uint32_t> lengths_;
+  uint32_t index_bits_;
+  uint32_t updates_;
+};
+
+}
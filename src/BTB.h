@@ -0,0 +1,70 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+#include <util.h>
+#include <checkpoint.h>
+
+namespace tinyrv {
+
+// branch target buffer
+// direct-mapped table of taken branch targets tagged with the full PC
+class BranchTargetBuffer {
+public:
+  BranchTargetBuffer(uint32_t size) : store_(size) {
+    assert(ispow2(size));
+    for (auto& entry : store_) {
+      entry = {false, 0, 0};
+    }
+  }
+
+  ~BranchTargetBuffer() {}
+
+  bool lookup(uint32_t PC, uint32_t* target) const {
+    auto& entry = store_[this->index(PC)];
+    if (!entry.valid || entry.tag != PC)
+      return false;
+    *target = entry.target;
+    return true;
+  }
+
+  void update(uint32_t PC, uint32_t target) {
+    store_[this->index(PC)] = {true, PC, target};
+  }
+
+  void save(CheckpointWriter& ckpt) const {
+    ckpt << store_;
+  }
+
+  void restore(CheckpointReader& ckpt) {
+    ckpt >> store_;
+  }
+
+private:
+
+  struct entry_t {
+    bool     valid;
+    uint32_t tag;
+    uint32_t target;
+  };
+
+  uint32_t index(uint32_t PC) const {
+    return (PC >> 2) & (store_.size() - 1);
+  }
+
+  std::vector<entry_t> store_;
+};
+
+}
@@ -18,6 +18,8 @@
 
 namespace tinyrv {
 
+// result buses shared by the functional units,
+// up to num_buses results are broadcast per cycle
 class CommonDataBus {
 public:
 
@@ -27,30 +29,50 @@ public:
     int      rs_index;
   };
 
-  CommonDataBus() : empty_(true) {}
+  CommonDataBus(uint32_t num_buses = 1) : num_buses_(num_buses) {
+    assert(num_buses != 0);
+    data_.reserve(num_buses);
+  }
 
   ~CommonDataBus() {}
 
   bool empty() const {
-    return empty_;
+    return data_.empty();
+  }
+
+  bool full() const {
+    return data_.size() == num_buses_;
+  }
+
+  uint32_t size() const {
+    return data_.size();
   }
 
-  const data_t& data() const {
-    return data_;
+  const data_t& data(uint32_t index) const {
+    return data_.at(index);
   }
 
   void push(uint32_t result, int rob_index, int rs_index) {
-    data_ = {result, rob_index, rs_index};
-    empty_ = false;
+    assert(!this->full());
+    data_.push_back({result, rob_index, rs_index});
   }
 
+  // release all buses
   void pop() {
-    empty_ = true;
+    data_.clear();
+  }
+
+  void save(CheckpointWriter& ckpt) const {
+    ckpt << data_;
+  }
+
+  void restore(CheckpointReader& ckpt) {
+    ckpt >> data_;
   }
 
 private:
-  bool   empty_;
-  data_t data_;
+  uint32_t num_buses_;
+  std::vector<data_t> data_;
 };
 
 }
\ No newline at end of file
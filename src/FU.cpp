@@ -128,22 +128,198 @@ static uint32_t execute_br_op(BrOp br_op, uint32_t rs1_data, uint32_t rs2_data)
 
 ///////////////////////////////////////////////////////////////////////////////
 
+ALU::ALU(Core* core)
+  : FunctionalUnit(FUType::ALU, core->arch_.fu_latency[(int)FUType::ALU], core->arch_.fu_interval[(int)FUType::ALU])
+  , core_(core)
+{}
+
 void ALU::do_execute() {
   result_ = execute_alu_op(*instr_, rs1_value_, rs2_value_);
 }
 
+BRU::BRU(Core* core)
+  : FunctionalUnit(FUType::BRU, core->arch_.fu_latency[(int)FUType::BRU], core->arch_.fu_interval[(int)FUType::BRU])
+  , core_(core)
+{}
+
 void BRU::do_execute() {
   auto br_op = instr_->getBrOp();
   auto br_taken = execute_br_op(br_op, rs1_value_, rs2_value_);
+  uint32_t next_PC = instr_->getPC() + 4;
   if (br_taken) {
-    auto br_target = execute_alu_op(*instr_, rs1_value_, rs2_value_);
-    core_->PC_ = br_target;
+    next_PC = execute_alu_op(*instr_, rs1_value_, rs2_value_);
     if (br_op == BrOp::JAL || br_op == BrOp::JALR) {
       result_ = instr_->getPC() + 4; // return PC + 4
     }
   }
-  DT(2, "Branch: " << (br_taken ? "taken" : "not-taken") << ", target=0x" << std::hex << core_->PC_ << std::dec << " (#" << instr_->getId() << ")");
-  core_->fetch_stalled_->write(false); // release fetch stage
+  instr_->setNextPC(next_PC);
+  DT(2, "Branch: " << (br_taken ? "taken" : "not-taken") << ", target=0x" << std::hex << next_PC << std::dec << " (#" << instr_->getId() << ")");
+  if (!core_->arch_.speculative()) {
+    core_->PC_ = next_PC;
+    core_->fetch_stalled_->write(false); // release fetch stage
+  }
+  // otherwise fetch has moved on, a misprediction squashes the wrong path
+  // and redirects fetch once the result is written back
+}
+
+// with the LSQ the unit is pipelined and keeps several accesses in flight,
+// without it a unit serializes the memory instructions
+LSU::LSU(Core* core)
+  : FunctionalUnit(FUType::LSU, core->arch_.fu_latency[(int)FUType::LSU],
+                   core->arch_.lsq ? core->arch_.fu_interval[(int)FUType::LSU] : core->arch_.fu_latency[(int)FUType::LSU])
+  , core_(core)
+  , timed_(core->arch_.timed_memory)
+  , lsq_(core->arch_.lsq)
+  , req_sent_(false)
+  , req_tag_(0)
+{}
+
+void LSU::issue(Instr::Ptr instr, int rob_index, int rs_index, uint32_t rs1_value, uint32_t rs2_value) {
+  FunctionalUnit::issue(instr, rob_index, rs_index, rs1_value, rs2_value);
+  if (!lsq_) {
+    if (!timed_) {
+      uint64_t mem_addr = execute_alu_op(*instr, rs1_value, rs2_value);
+      ops_.back().latency = this->access_latency(mem_addr, instr->getExeFlags().is_store);
+    }
+    req_sent_ = false;
+    ++req_tag_;
+    return;
+  }
+
+  // a store only generates its address, memory is written at commit,
+  // and a load served by an older store skips the memory access
+  auto& op = ops_.back();
+  uint64_t mem_addr = execute_alu_op(*instr, rs1_value, rs2_value);
+  uint32_t data_bytes = 1 << (instr->getFunc3() & 0x3);
+  uint32_t data = 0;
+  if (instr->getExeFlags().is_store) {
+    core_->LSQ_.set_store(rob_index, mem_addr, data_bytes, rs2_value);
+    op.latency = core_->arch_.agu_latency;
+  } else if (core_->LSQ_.search(rob_index, mem_addr, data_bytes, &data) == LoadStoreQueue::Match::FORWARD) {
+    op.latency = core_->arch_.agu_latency;
+    ++core_->perf_stats_.store_forwards;
+  } else if (timed_) {
+    op.latency = 0; // completes on the memory response
+  } else {
+    op.latency = this->access_latency(mem_addr, false);
+  }
+}
+
+uint32_t LSU::access_latency(uint64_t addr, bool write) {
+  auto dcache = core_->dcache_;
+  if (!dcache)
+    return core_->arch_.fu_latency[(int)FUType::LSU];
+  return dcache->access(addr, write);
+}
+
+void LSU::execute() {
+  if (!timed_) {
+    FunctionalUnit::execute();
+    return;
+  }
+
+  if (lsq_) {
+    this->execute_lsq();
+    return;
+  }
+
+  // drop responses to accesses squashed while in flight
+  auto& rsp_port = core_->dmem_rsp_port;
+  while (!rsp_port.empty() && !(!ops_.empty() && req_sent_ && rsp_port.front().tag == req_tag_)) {
+    rsp_port.pop();
+  }
+
+  if (ops_.empty() || ops_.front().done)
+    return;
+
+  auto& op = ops_.front();
+
+  if (!req_sent_) {
+    // send the access to the memory model
+    auto exe_flags = op.instr->getExeFlags();
+    uint64_t mem_addr = execute_alu_op(*op.instr, op.rs1_value, op.rs2_value);
+    core_->dmem_req_port.send(MemReq{mem_addr, (bool)exe_flags.is_store, req_tag_, core_->core_id_, op.instr->getId()});
+    req_sent_ = true;
+    return;
+  }
+
+  // complete the access once the memory responds
+  if (!core_->dmem_rsp_port.empty()) {
+    DT(3, "LSU-" << core_->dmem_rsp_port.front());
+    core_->dmem_rsp_port.pop();
+    this->complete(op);
+  }
+}
+
+void LSU::execute_lsq() {
+  // count down the address generations and forwards
+  FunctionalUnit::execute();
+
+  // send the new loads to the memory model, they are tagged by instruction id
+  auto& rsp_port = core_->dmem_rsp_port;
+  for (auto& op : ops_) {
+    if (op.latency == 0 && op.cycles == 1) {
+      uint64_t mem_addr = execute_alu_op(*op.instr, op.rs1_value, op.rs2_value);
+      core_->dmem_req_port.send(MemReq{mem_addr, false, 0, core_->core_id_, op.instr->getId()});
+    }
+  }
+
+  // complete the loads that got their response on the unit that sent them,
+  // others answer squashed loads or committed stores
+  while (!rsp_port.empty()) {
+    auto& mem_rsp = rsp_port.front();
+    for (auto& fu : core_->FUs_) {
+      if (fu->type() == FUType::LSU && static_cast<LSU*>(fu.get())->complete_load(mem_rsp))
+        break;
+    }
+    rsp_port.pop();
+  }
+}
+
+bool LSU::complete_load(const MemRsp& mem_rsp) {
+  for (auto& op : ops_) {
+    if (op.latency == 0 && !op.done && op.instr->getId() == mem_rsp.uuid) {
+      DT(3, "LSU-" << mem_rsp);
+      this->complete(op);
+      return true;
+    }
+  }
+  return false;
+}
+
+uint64_t LSU::idle_cycles() const {
+  if (!timed_)
+    return FunctionalUnit::idle_cycles();
+  if (lsq_) {
+    // a load request to send or a response to take
+    if (!core_->dmem_rsp_port.empty())
+      return 0;
+    for (auto& op : ops_) {
+      if (op.latency == 0 && op.cycles == 0)
+        return 0;
+    }
+    return FunctionalUnit::idle_cycles();
+  }
+  // waiting on the memory response event
+  if (req_sent_ && core_->dmem_rsp_port.empty())
+    return UINT64_MAX;
+  return 0;
+}
+
+void LSU::skip(uint64_t cycles) {
+  if (!timed_ || lsq_) {
+    FunctionalUnit::skip(cycles);
+  }
+}
+
+void LSU::save(CheckpointWriter& ckpt) const {
+  FunctionalUnit::save(ckpt);
+  ckpt << req_sent_ << req_tag_;
+}
+
+void LSU::restore(CheckpointReader& ckpt) {
+  FunctionalUnit::restore(ckpt);
+  ckpt >> req_sent_ >> req_tag_;
 }
 
 void LSU::do_execute() {
@@ -155,7 +331,10 @@ void LSU::do_execute() {
     uint32_t data_bytes = 1 << (func3 & 0x3);
     uint32_t data_width = 8 * data_bytes;
     uint32_t read_data = 0;
-    core_->dmem_read(&read_data, mem_addr, data_bytes);
+    if (!lsq_ || core_->LSQ_.search(rob_index_, mem_addr, data_bytes, &read_data) != LoadStoreQueue::Match::FORWARD) {
+      core_->dmem_read(&read_data, mem_addr, data_bytes);
+    }
+    core_->train_prefetcher(instr_->getPC(), mem_addr);
     switch (func3) {
     case 0: // RV32I: LB
     case 1: // RV32I: LH
@@ -171,7 +350,7 @@ void LSU::do_execute() {
     default:
       std::abort();
     }
-  } else if (exe_flags.is_store) {
+  } else if (exe_flags.is_store && !lsq_) {
     uint64_t mem_addr = execute_alu_op(*instr_, rs1_value_, rs2_value_);
     uint32_t data_bytes = 1 << (func3 & 0x3);
     switch (func3) {
@@ -186,6 +365,11 @@ void LSU::do_execute() {
   }
 }
 
+SFU::SFU(Core* core)
+  : FunctionalUnit(FUType::SFU, core->arch_.fu_latency[(int)FUType::SFU], core->arch_.fu_interval[(int)FUType::SFU])
+  , core_(core)
+{}
+
 void SFU::do_execute() {
   auto csr_data = core_->get_csr(instr_->getImm());
   auto rd_data = execute_alu_op(*instr_, rs1_value_, csr_data);
@@ -13,6 +13,8 @@
 
 #pragma once
 
+#include <deque>
+#include <algorithm>
 #include "instr.h"
 
 namespace tinyrv {
@@ -29,81 +31,180 @@ public:
     uint32_t result;
   };
 
-  FunctionalUnit(uint32_t latency)
-    : latency_(latency)
-    , cycles_(0)
-    , busy_(false)
-    , done_(false)
-  {}
+  // A unit accepts a new operation every interval cycles, an interval
+  // equal to the latency gives a non-pipelined unit. Operations hold their
+  // result until the CDB takes it, the oldest completed one first.
+  FunctionalUnit(FUType type, uint32_t latency, uint32_t interval)
+    : type_(type)
+    , latency_(latency)
+    , interval_(interval)
+    , capacity_((latency + interval - 1) / interval)
+  {
+    assert(latency != 0 && interval != 0);
+  }
 
   virtual ~FunctionalUnit() {}
 
-  void execute() {
-    if (!busy_ || done_)
-      return;
-
-    if (++cycles_ == latency_) {
-      this->do_execute();
-      done_ = true;
+  virtual void execute() {
+    for (auto& op : ops_) {
+      if (!op.done && ++op.cycles == op.latency) {
+        this->complete(op);
+      }
     }
   }
 
+  FUType type() const {
+    return type_;
+  }
+
+  // no operation in flight
+  bool empty() const {
+    return ops_.empty();
+  }
+
+  // cannot accept an operation this cycle
   bool busy() const {
-    return busy_;
+    return !ops_.empty()
+        && (ops_.size() >= capacity_ || ops_.back().cycles < interval_);
   }
 
+  // idle cycles before a busy unit accepts an operation again,
+  // a full one waits for an operation to leave
+  uint64_t busy_cycles() const {
+    if (ops_.size() >= capacity_)
+      return UINT64_MAX;
+    return interval_ - ops_.back().cycles - 1;
+  }
+
+  // an operation completed
   bool done() const {
-    return done_;
+    return this->next_done() != ops_.end();
+  }
+
+  // cycles before the next operation completes,
+  // an operation without latency waits on an event
+  virtual uint64_t idle_cycles() const {
+    uint64_t cycles = UINT64_MAX;
+    for (auto& op : ops_) {
+      if (!op.done && op.latency != 0) {
+        cycles = std::min<uint64_t>(cycles, op.latency - op.cycles - 1);
+      }
+    }
+    return cycles;
+  }
+
+  // execute() ages every operation in flight, those waiting on an event too
+  virtual void skip(uint64_t cycles) {
+    for (auto& op : ops_) {
+      if (!op.done) {
+        op.cycles += (uint32_t)cycles;
+        assert(op.latency == 0 || op.cycles < op.latency);
+      }
+    }
   }
 
   data_out_t get_output() const {
-    return {rob_index_, rs_index_, result_};
+    auto& op = *this->next_done();
+    return {op.rob_index, op.rs_index, op.result};
   }
 
-  void issue(Instr::Ptr instr, int rob_index, int rs_index, uint32_t rs1_value, uint32_t rs2_value) {
-    instr_     = instr;
-    rob_index_ = rob_index;
-    rs_index_  = rs_index;
-    rs1_value_ = rs1_value;
-    rs2_value_ = rs2_value;
-    busy_      = true;
-    done_      = false;
-    cycles_    = 0;
+  virtual void issue(Instr::Ptr instr, int rob_index, int rs_index, uint32_t rs1_value, uint32_t rs2_value) {
+    ops_.push_back({instr, rs1_value, rs2_value, 0, rob_index, rs_index, latency_, 0, false});
   }
 
+  // release the oldest completed operation
   void clear() {
-    busy_ = false;
-    done_ = false;
+    ops_.erase(this->next_done());
+  }
+
+  // drop the operations of squashed instructions
+  template <typename Pred>
+  void discard(const Pred& squashed) {
+    for (auto it = ops_.begin(); it != ops_.end();) {
+      if (squashed(it->rob_index)) {
+        it = ops_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  virtual void save(CheckpointWriter& ckpt) const {
+    ckpt << ops_;
+  }
+
+  virtual void restore(CheckpointReader& ckpt) {
+    ckpt >> ops_;
   }
 
 protected:
 
+  struct op_t {
+    Instr::Ptr instr;
+    uint32_t   rs1_value;
+    uint32_t   rs2_value;
+    uint32_t   result;
+    int        rob_index;
+    int        rs_index;
+    uint32_t   latency;   // 0 completes on an external event
+    uint32_t   cycles;
+    bool       done;
+
+    friend CheckpointWriter& operator<<(CheckpointWriter& ckpt, const op_t& op) {
+      return ckpt << op.instr << op.rs1_value << op.rs2_value << op.result
+                  << op.rob_index << op.rs_index << op.latency << op.cycles << op.done;
+    }
+
+    friend CheckpointReader& operator>>(CheckpointReader& ckpt, op_t& op) {
+      return ckpt >> op.instr >> op.rs1_value >> op.rs2_value >> op.result
+                  >> op.rob_index >> op.rs_index >> op.latency >> op.cycles >> op.done;
+    }
+  };
+
+  std::deque<op_t>::const_iterator next_done() const {
+    for (auto it = ops_.begin(); it != ops_.end(); ++it) {
+      if (it->done)
+        return it;
+    }
+    return ops_.end();
+  }
+
+  // run do_execute() on an operation
+  void complete(op_t& op) {
+    instr_     = op.instr;
+    rob_index_ = op.rob_index;
+    rs1_value_ = op.rs1_value;
+    rs2_value_ = op.rs2_value;
+    result_    = 0;
+    this->do_execute();
+    op.result  = result_;
+    op.done    = true;
+  }
+
   virtual void do_execute() = 0;
 
+  // operation being executed by do_execute()
   Instr::Ptr instr_;
+  int       rob_index_;
   uint32_t  rs1_value_;
   uint32_t  rs2_value_;
   uint32_t  result_;
 
-private:
+  std::deque<op_t> ops_;
 
-  int       rob_index_;
-  int       rs_index_;
+private:
 
+  FUType    type_;
   uint32_t  latency_;
-  uint32_t  cycles_;
-  bool      busy_;
-  bool      done_;
+  uint32_t  interval_;
+  uint32_t  capacity_;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
 class ALU : public FunctionalUnit {
 public:
-  ALU(Core* core)
-    : FunctionalUnit(ALU_LATENCY)
-    , core_(core)
-  {}
+  ALU(Core* core);
 
   void do_execute();
 
@@ -115,10 +216,7 @@ private:
 
 class BRU : public FunctionalUnit {
 public:
-  BRU(Core* core)
-    : FunctionalUnit(BRU_LATENCY)
-    , core_(core)
-  {}
+  BRU(Core* core);
 
   void do_execute();
 
@@ -130,25 +228,42 @@ private:
 
 class LSU : public FunctionalUnit {
 public:
-  LSU(Core* core)
-    : FunctionalUnit(LSU_LATENCY)
-    , core_(core)
-  {}
+  LSU(Core* core);
+
+  void execute() override;
+
+  void issue(Instr::Ptr instr, int rob_index, int rs_index, uint32_t rs1_value, uint32_t rs2_value) override;
+
+  uint64_t idle_cycles() const override;
+
+  void skip(uint64_t cycles) override;
+
+  void save(CheckpointWriter& ckpt) const override;
+
+  void restore(CheckpointReader& ckpt) override;
 
   void do_execute();
 
 private:
+  void execute_lsq();
+
+  // complete the load a memory response answers, if sent by this unit
+  bool complete_load(const MemRsp& mem_rsp);
+
+  uint32_t access_latency(uint64_t addr, bool write);
+
   Core* core_;
+  bool  timed_;     // access timing comes from the memory model
+  bool  lsq_;       // memory ordering from the load/store queue
+  bool  req_sent_;  // memory request in flight
+  uint32_t req_tag_; // tags the request of the current access
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
 class SFU : public FunctionalUnit {
 public:
-  SFU(Core* core)
-    : FunctionalUnit(SFU_LATENCY)
-    , core_(core)
-  {}
+  SFU(Core* core);
 
   void do_execute();
 
@@ -0,0 +1,116 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <assert.h>
+#include <util.h>
+#include "types.h"
+#include "debug.h"
+#include "LSQ.h"
+
+using namespace tinyrv;
+
+LoadStoreQueue::LoadStoreQueue(uint32_t lq_size, uint32_t sq_size)
+  : lq_size_(lq_size)
+  , sq_size_(sq_size)
+  , sq_seq_(0)
+{
+  assert(lq_size != 0 && sq_size != 0);
+}
+
+LoadStoreQueue::~LoadStoreQueue() {
+  //--
+}
+
+bool LoadStoreQueue::full(const Instr& instr) const {
+  auto exe_flags = instr.getExeFlags();
+  if (exe_flags.is_load)
+    return lq_.size() == lq_size_;
+  if (exe_flags.is_store)
+    return sq_.size() == sq_size_;
+  return false;
+}
+
+void LoadStoreQueue::allocate(const Instr& instr, int rob_index) {
+  assert(!this->full(instr));
+  auto exe_flags = instr.getExeFlags();
+  if (exe_flags.is_load) {
+    lq_.push_back({rob_index, sq_seq_});
+  } else if (exe_flags.is_store) {
+    sq_.push_back({rob_index, sq_seq_++, false, 0, 0, 0});
+  }
+}
+
+void LoadStoreQueue::set_store(int rob_index, uint64_t addr, uint32_t size, uint32_t data) {
+  for (auto& entry : sq_) {
+    if (entry.rob_index == rob_index) {
+      entry.addr_valid = true;
+      entry.addr = addr;
+      entry.size = size;
+      entry.data = data;
+      return;
+    }
+  }
+  std::abort();
+}
+
+LoadStoreQueue::Match LoadStoreQueue::search(int rob_index, uint64_t addr, uint32_t size, uint32_t* data) const {
+  uint32_t sq_seq = 0;
+  bool found = false;
+  for (auto& entry : lq_) {
+    if (entry.rob_index == rob_index) {
+      sq_seq = entry.sq_seq;
+      found = true;
+      break;
+    }
+  }
+  assert(found);
+  __unused (found);
+
+  // walk the older stores from the youngest
+  for (auto it = sq_.rbegin(); it != sq_.rend(); ++it) {
+    auto& entry = *it;
+    if (entry.seq >= sq_seq)
+      continue;
+    if (!entry.addr_valid)
+      return Match::WAIT;
+    if (addr + size <= entry.addr || entry.addr + entry.size <= addr)
+      continue;
+    if (addr < entry.addr || addr + size > entry.addr + entry.size)
+      return Match::WAIT;
+    uint32_t shift = 8 * (addr - entry.addr);
+    uint64_t mask = (1ull << (8 * size)) - 1;
+    *data = uint32_t((uint64_t(entry.data) >> shift) & mask);
+    return Match::FORWARD;
+  }
+  return Match::NONE;
+}
+
+void LoadStoreQueue::pop_load() {
+  assert(!lq_.empty());
+  lq_.pop_front();
+}
+
+void LoadStoreQueue::pop_store() {
+  assert(!sq_.empty());
+  assert(sq_.front().addr_valid);
+  sq_.pop_front();
+}
+
+void LoadStoreQueue::save(CheckpointWriter& ckpt) const {
+  ckpt << lq_ << sq_ << sq_seq_;
+}
+
+void LoadStoreQueue::restore(CheckpointReader& ckpt) {
+  ckpt >> lq_ >> sq_ >> sq_seq_;
+}
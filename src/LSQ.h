@@ -0,0 +1,117 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <deque>
+#include "instr.h"
+
+namespace tinyrv {
+
+// load and store queues
+// Memory instructions enter in program order at issue and leave at commit.
+// A store records its address and data when dispatched and writes memory
+// at commit. A load may only access memory once every older store has a
+// known address: the youngest older store it overlaps either forwards
+// its data or, on a partial overlap, holds the load until it commits.
+class LoadStoreQueue {
+public:
+
+  enum class Match {
+    NONE,     // no older store overlaps, read memory
+    FORWARD,  // an older store holds all the bytes
+    WAIT      // an older store address is unknown or partially overlaps
+  };
+
+  struct store_t {
+    int      rob_index;
+    uint32_t seq;         // allocation order
+    bool     addr_valid;  // address generated
+    uint64_t addr;
+    uint32_t size;
+    uint32_t data;
+  };
+
+  LoadStoreQueue(uint32_t lq_size, uint32_t sq_size);
+
+  ~LoadStoreQueue();
+
+  // no free entry for this memory instruction
+  bool full(const Instr& instr) const;
+
+  void allocate(const Instr& instr, int rob_index);
+
+  // a dispatched store provides its address and data
+  void set_store(int rob_index, uint64_t addr, uint32_t size, uint32_t data);
+
+  // check a load against the older stores, data is set on a forward
+  Match search(int rob_index, uint64_t addr, uint32_t size, uint32_t* data) const;
+
+  // oldest store, written to memory at commit
+  const store_t& store_head() const {
+    return sq_.front();
+  }
+
+  void pop_load();
+
+  void pop_store();
+
+  // drop the entries of squashed instructions
+  template <typename Pred>
+  void squash(const Pred& squashed) {
+    while (!lq_.empty() && squashed(lq_.back().rob_index)) {
+      lq_.pop_back();
+    }
+    while (!sq_.empty() && squashed(sq_.back().rob_index)) {
+      sq_seq_ = sq_.back().seq;
+      sq_.pop_back();
+    }
+  }
+
+  void save(CheckpointWriter& ckpt) const;
+
+  void restore(CheckpointReader& ckpt);
+
+private:
+
+  struct load_t {
+    int      rob_index;
+    uint32_t sq_seq;      // stores allocated before this load
+  };
+
+  friend CheckpointWriter& operator<<(CheckpointWriter& ckpt, const load_t& entry) {
+    return ckpt << entry.rob_index << entry.sq_seq;
+  }
+
+  friend CheckpointReader& operator>>(CheckpointReader& ckpt, load_t& entry) {
+    return ckpt >> entry.rob_index >> entry.sq_seq;
+  }
+
+  friend CheckpointWriter& operator<<(CheckpointWriter& ckpt, const store_t& entry) {
+    return ckpt << entry.rob_index << entry.seq << entry.addr_valid
+                << entry.addr << entry.size << entry.data;
+  }
+
+  friend CheckpointReader& operator>>(CheckpointReader& ckpt, store_t& entry) {
+    return ckpt >> entry.rob_index >> entry.seq >> entry.addr_valid
+                >> entry.addr >> entry.size >> entry.data;
+  }
+
+  std::deque<load_t>  lq_;
+  std::deque<store_t> sq_;
+  uint32_t lq_size_;
+  uint32_t sq_size_;
+  uint32_t sq_seq_;
+};
+
+}
@@ -0,0 +1,142 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <assert.h>
+#include <checkpoint.h>
+
+namespace tinyrv {
+
+// merged physical register file
+// Architectural and speculative values share one pool of registers.
+// The speculative map renames at issue, the architectural map tracks
+// committed state; a result is written once at writeback and commit
+// only releases the register the destination was previously mapped to.
+class PhysicalRegisterFile {
+public:
+  PhysicalRegisterFile(uint32_t size, uint32_t num_regs)
+    : values_(size, 0)
+    , ready_(size, false)
+    , rob_index_(size, -1)
+  {
+    // an empty file leaves renaming to the ROB
+    if (size == 0)
+      return;
+    assert(size > num_regs);
+    for (uint32_t i = 0; i < num_regs; ++i) {
+      spec_map_.push_back(i);
+      ready_[i] = true;
+    }
+    arch_map_ = spec_map_;
+    for (uint32_t i = num_regs; i < size; ++i) {
+      free_list_.push_back(i);
+    }
+  }
+
+  ~PhysicalRegisterFile() {}
+
+  uint32_t size() const {
+    return values_.size();
+  }
+
+  // no free register to rename a destination
+  bool full() const {
+    return free_list_.empty();
+  }
+
+  // current speculative mapping of an architectural register
+  uint32_t map(uint32_t reg) const {
+    return spec_map_.at(reg);
+  }
+
+  bool ready(uint32_t preg) const {
+    return ready_.at(preg);
+  }
+
+  uint32_t read(uint32_t preg) const {
+    assert(ready_.at(preg));
+    return values_.at(preg);
+  }
+
+  // ROB entry producing a register not yet written
+  int producer(uint32_t preg) const {
+    assert(!ready_.at(preg));
+    return rob_index_.at(preg);
+  }
+
+  // committed value of an architectural register
+  uint32_t arch_value(uint32_t reg) const {
+    return values_.at(arch_map_.at(reg));
+  }
+
+  // rename a destination register to a free physical register
+  uint32_t allocate(uint32_t reg, int rob_index) {
+    assert(!this->full());
+    uint32_t preg = free_list_.front();
+    free_list_.pop_front();
+    ready_[preg] = false;
+    rob_index_[preg] = rob_index;
+    spec_map_.at(reg) = preg;
+    return preg;
+  }
+
+  void write(uint32_t preg, uint32_t value) {
+    assert(!ready_.at(preg));
+    values_[preg] = value;
+    ready_[preg] = true;
+  }
+
+  // the destination becomes architectural, its previous register is free
+  void commit(uint32_t reg, uint32_t preg) {
+    auto& mapping = arch_map_.at(reg);
+    free_list_.push_back(mapping);
+    mapping = preg;
+  }
+
+  // return the register of a squashed instruction
+  void release(uint32_t preg) {
+    ready_.at(preg) = false;
+    free_list_.push_back(preg);
+  }
+
+  // roll the speculative map back to the committed state,
+  // the caller then replays the surviving in-flight destinations
+  void rollback() {
+    spec_map_ = arch_map_;
+  }
+
+  void rename(uint32_t reg, uint32_t preg) {
+    spec_map_.at(reg) = preg;
+  }
+
+  void save(CheckpointWriter& ckpt) const {
+    ckpt << values_ << ready_ << rob_index_ << spec_map_ << arch_map_ << free_list_;
+  }
+
+  void restore(CheckpointReader& ckpt) {
+    ckpt >> values_ >> ready_ >> rob_index_ >> spec_map_ >> arch_map_ >> free_list_;
+  }
+
+private:
+  std::vector<uint32_t> values_;
+  std::vector<uint8_t> ready_;
+  std::vector<int> rob_index_;     // producer of registers not yet written
+  std::vector<uint32_t> spec_map_; // speculative map table
+  std::vector<uint32_t> arch_map_; // architectural map table
+  std::deque<uint32_t> free_list_;
+};
+
+}
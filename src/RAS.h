@@ -0,0 +1,71 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+#include <util.h>
+#include <checkpoint.h>
+
+namespace tinyrv {
+
+// return address stack
+// a circular stack updated speculatively at fetch, overflow overwrites the
+// oldest entries. A branch records the top index and top value after its own
+// update, a squash restores both.
+class ReturnAddressStack {
+public:
+  ReturnAddressStack(uint32_t size) : store_(size, 0), top_(0) {
+    assert(ispow2(size));
+  }
+
+  ~ReturnAddressStack() {}
+
+  void push(uint32_t addr) {
+    top_ = (top_ + 1) & (store_.size() - 1);
+    store_[top_] = addr;
+  }
+
+  uint32_t pop() {
+    uint32_t addr = store_[top_];
+    top_ = (top_ - 1) & (store_.size() - 1);
+    return addr;
+  }
+
+  uint32_t top_index() const {
+    return top_;
+  }
+
+  uint32_t top_value() const {
+    return store_[top_];
+  }
+
+  void restore(uint32_t top_index, uint32_t top_value) {
+    top_ = top_index;
+    store_[top_] = top_value;
+  }
+
+  void save(CheckpointWriter& ckpt) const {
+    ckpt << store_ << top_;
+  }
+
+  void restore(CheckpointReader& ckpt) {
+    ckpt >> store_ >> top_;
+  }
+
+private:
+  std::vector<uint32_t> store_;
+  uint32_t top_;
+};
+
+}
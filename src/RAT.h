@@ -43,6 +43,20 @@ public:
     store_.at(index) = {false, 0};
   }
 
+  void flush() {
+    for (auto& entry : store_) {
+      entry = {false, 0};
+    }
+  }
+
+  void save(CheckpointWriter& ckpt) const {
+    ckpt << store_;
+  }
+
+  void restore(CheckpointReader& ckpt) {
+    ckpt >> store_;
+  }
+
 private:
   std::vector<std::pair<bool, int>> store_;
 };
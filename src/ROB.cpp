@@ -74,6 +74,52 @@ int ReorderBuffer::pop() {
   return head_index_;
 }
 
+// an entry is speculative while an older branch is unresolved
+// or an older exit instruction is pending
+bool ReorderBuffer::speculative(int index) const {
+  for (int i = head_index_; i != index; i = (i + 1) % store_.size()) {
+    auto& entry = store_[i];
+    auto& instr = *entry.instr;
+    if (instr.getExeFlags().is_exit)
+      return true;
+    if (instr.getBrOp() != BrOp::NONE && !entry.ready)
+      return true;
+  }
+  return false;
+}
+
+// drop every entry younger than index
+void ReorderBuffer::squash(int index) {
+  int size = store_.size();
+  int last = (index + 1) % size;
+  while (count_ != 0 && tail_index_ != last) {
+    tail_index_ = (tail_index_ + size - 1) % size;
+    auto& entry = store_[tail_index_];
+    entry.valid = false;
+    entry.ready = false;
+    entry.instr = nullptr;
+    --count_;
+  }
+}
+
+void ReorderBuffer::save(CheckpointWriter& ckpt) const {
+  ckpt << uint64_t(store_.size());
+  for (auto& entry : store_) {
+    ckpt << entry.valid << entry.ready << entry.result << entry.instr;
+  }
+  ckpt << head_index_ << tail_index_ << count_;
+}
+
+void ReorderBuffer::restore(CheckpointReader& ckpt) {
+  uint64_t size = 0;
+  ckpt >> size;
+  assert(size == store_.size());
+  for (auto& entry : store_) {
+    ckpt >> entry.valid >> entry.ready >> entry.result >> entry.instr;
+  }
+  ckpt >> head_index_ >> tail_index_ >> count_;
+}
+
 void ReorderBuffer::dump() {
   for (int i = 0; i < (int)store_.size(); ++i) {
     auto& entry = store_[i];
@@ -47,10 +47,31 @@ public:
 
   void update(const CommonDataBus::data_t& data);
 
+  bool speculative(int index) const;
+
+  void squash(int index);
+
   int head_index() const {
     return head_index_;
   }
 
+  int tail_index() const {
+    return tail_index_;
+  }
+
+  uint32_t count() const {
+    return count_;
+  }
+
+  // distance from the head, older entries are smaller
+  uint32_t age(int index) const {
+    return (index - head_index_ + store_.size()) % store_.size();
+  }
+
+  uint32_t size() const {
+    return store_.size();
+  }
+
   const rob_entry_t& get_entry(int index) const {
     return store_.at(index);
   }
@@ -61,6 +82,10 @@ public:
 
   void dump();
 
+  void save(CheckpointWriter& ckpt) const;
+
+  void restore(CheckpointReader& ckpt);
+
 private:
 
   std::vector<rob_entry_t> store_;
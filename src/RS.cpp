@@ -20,45 +20,173 @@
 
 using namespace tinyrv;
 
-ReservationStation::ReservationStation(uint32_t size)
-  : store_(size)
-  , indices_(size)
-  , next_index_(0) {
-  for (uint32_t i = 0; i < size; ++i) {
-    store_[i].valid = false;
-    indices_[i] = i;
+ReservationStation::ReservationStation(uint32_t size) {
+  this->init(size);
+  partitions_.push_back({FUType::NONE, 0, size, 0});
+  for (auto& part : part_map_) {
+    part = 0;
+  }
+}
+
+ReservationStation::ReservationStation(const std::vector<uint32_t>& sizes) {
+  assert(sizes.size() == NUM_FUS);
+  uint32_t base = 0;
+  for (uint32_t t = 0; t < NUM_FUS; ++t) {
+    assert(sizes[t] != 0);
+    part_map_[t] = partitions_.size();
+    partitions_.push_back({FUType(t), base, sizes[t], 0});
+    base += sizes[t];
   }
+  this->init(base);
 }
 
 ReservationStation::~ReservationStation() {}
 
+void ReservationStation::init(uint32_t size) {
+  valid_ = BitVector(size);
+  pending_ = BitVector(size);
+  ready_ = BitVector(size);
+  deps_.resize(size, BitVector(size));
+  rob_index_.resize(size);
+  rs1_index_.resize(size);
+  rs2_index_.resize(size);
+  rs1_data_.resize(size);
+  rs2_data_.resize(size);
+  barrier_id_.resize(size);
+  type_.resize(size);
+  instr_.resize(size);
+  indices_.resize(size);
+  for (uint32_t i = 0; i < size; ++i) {
+    indices_[i] = i;
+  }
+}
+
 int ReservationStation::issue(int rob_index, int rs1_index, int rs2_index, uint32_t rs1_data, uint32_t rs2_data, Instr::Ptr instr) {
-    assert(!this->full());
-    int index = indices_[next_index_++];
-    uint32_t barrier_id = 0;
-    if (instr->getFUType() == FUType::LSU) {
-      barrier_id = lsu_barrier_.tick();
-    }
-    store_[index] = {true, false, rob_index, rs1_index, rs2_index, rs1_data, rs2_data, barrier_id, instr};
-    assert(index != rs1_index);
-    assert(index != rs2_index);
-    return index;
+  auto type = instr->getFUType();
+  assert(!this->full(type));
+  auto& part = partitions_.at(part_map_[(int)type]);
+  int index = indices_[part.base + part.next_index++];
+  uint32_t barrier_id = 0;
+  if (type == FUType::LSU) {
+    barrier_id = lsu_barrier_.tick();
   }
+  assert(index != rs1_index);
+  assert(index != rs2_index);
+
+  valid_.set(index);
+  pending_.set(index);
+  rob_index_[index]  = rob_index;
+  rs1_index_[index]  = rs1_index;
+  rs2_index_[index]  = rs2_index;
+  rs1_data_[index]   = rs1_data;
+  rs2_data_[index]   = rs2_data;
+  barrier_id_[index] = barrier_id;
+  type_[index]       = type;
+  instr_[index]      = instr;
 
-  void ReservationStation::release(uint32_t index) {
-    assert(!this->empty());
-    auto& entry = store_.at(index);
-    entry.valid = false;
-    entry.running = false;
-    if (entry.instr->getFUType() == FUType::LSU) {
-      lsu_barrier_.tock();
+  // register with the producers of missing operands
+  if (rs1_index != -1) {
+    assert(valid_.test(rs1_index));
+    deps_[rs1_index].set(index);
+  }
+  if (rs2_index != -1) {
+    assert(valid_.test(rs2_index));
+    deps_[rs2_index].set(index);
+  }
+  if (rs1_index == -1 && rs2_index == -1) {
+    ready_.set(index);
+  }
+  return index;
+}
+
+void ReservationStation::wakeup(const CommonDataBus::data_t& data) {
+  // update operands of the RS entries waiting for them
+  auto& deps = deps_.at(data.rs_index);
+  for (uint32_t i = deps.find_next(0); i < this->size(); i = deps.find_next(i + 1)) {
+    if (rs1_index_[i] == data.rs_index) {
+      rs1_data_[i] = data.result;
+      rs1_index_[i] = -1;
+    }
+    if (rs2_index_[i] == data.rs_index) {
+      rs2_data_[i] = data.result;
+      rs2_index_[i] = -1;
+    }
+    if (rs1_index_[i] == -1 && rs2_index_[i] == -1) {
+      ready_.set(i);
     }
-    indices_[--next_index_] = index;
   }
+  deps.clear();
+}
+
+void ReservationStation::release(uint32_t index) {
+  auto& part = this->partition(index);
+  assert(part.next_index != 0);
+  assert(valid_.test(index));
+  valid_.reset(index);
+  pending_.reset(index);
+  ready_.reset(index);
+  if (type_[index] == FUType::LSU) {
+    lsu_barrier_.tock();
+  }
+  indices_[part.base + --part.next_index] = index;
+}
+
+// drop a squashed entry, its LSU ticket is the youngest and is handed back
+void ReservationStation::discard(uint32_t index) {
+  auto& part = this->partition(index);
+  assert(part.next_index != 0);
+  assert(valid_.test(index));
+  valid_.reset(index);
+  pending_.reset(index);
+  ready_.reset(index);
+  if (rs1_index_[index] != -1) {
+    deps_[rs1_index_[index]].reset(index);
+  }
+  if (rs2_index_[index] != -1) {
+    deps_[rs2_index_[index]].reset(index);
+  }
+  deps_[index].clear();
+  if (type_[index] == FUType::LSU) {
+    lsu_barrier_.untick();
+  }
+  instr_[index] = nullptr;
+  indices_[part.base + --part.next_index] = index;
+}
 
-  bool ReservationStation::locked(uint32_t index) const {
-    auto& entry = store_.at(index);
-    if (!entry.valid || entry.instr->getFUType() != FUType::LSU)
-      return false;
-    return !lsu_barrier_.ready(entry.barrier_id);
+void ReservationStation::save(CheckpointWriter& ckpt) const {
+  ckpt << uint64_t(this->size());
+  ckpt << valid_ << pending_ << ready_ << deps_
+       << rob_index_ << rs1_index_ << rs2_index_ << rs1_data_ << rs2_data_
+       << barrier_id_ << type_ << instr_;
+  ckpt << indices_ << lsu_barrier_;
+  for (auto& part : partitions_) {
+    ckpt << part.next_index;
   }
+}
+
+void ReservationStation::restore(CheckpointReader& ckpt) {
+  uint64_t size = 0;
+  ckpt >> size;
+  assert(size == this->size());
+  ckpt >> valid_ >> pending_ >> ready_ >> deps_
+       >> rob_index_ >> rs1_index_ >> rs2_index_ >> rs1_data_ >> rs2_data_
+       >> barrier_id_ >> type_ >> instr_;
+  ckpt >> indices_ >> lsu_barrier_;
+  for (auto& part : partitions_) {
+    ckpt >> part.next_index;
+  }
+}
+
+bool ReservationStation::locked(uint32_t index) const {
+  if (!valid_.test(index) || type_[index] != FUType::LSU)
+    return false;
+  return !lsu_barrier_.ready(barrier_id_[index]);
+}
+
+ReservationStation::partition_t& ReservationStation::partition(uint32_t index) {
+  for (auto& part : partitions_) {
+    if (index < part.base + part.size)
+      return part;
+  }
+  std::abort();
+}
@@ -13,97 +13,143 @@
 // limitations under the License.
 
 #include <vector>
+#include <bitvector.h>
 #include "instr.h"
 #include "CDB.h"
 
 namespace tinyrv {
 
+// Scheduler state is kept as structure of arrays. Valid/pending/ready
+// bitmasks drive selection with find-first-set, and a producer-to-consumer
+// dependency matrix limits wakeup to the entries waiting on a result.
 class ReservationStation {
 public:
 
-  struct entry_t {
-    bool valid;       // valid entry
-    bool running;     // has been assigned an FU
-    int rob_index;    // allocated ROB index
-    int rs1_index;    // RS producing rs1 (-1 indicates data is already available)
-    int rs2_index;    // RS producing rs2 (-1 indicates data is already available)
-    uint32_t rs1_data; // rs1 data
-    uint32_t rs2_data; // rs2 data
-    uint32_t barrier_id; // barrier id to enforce ordering fo LSU instructions
-    Instr::Ptr instr; // instruction data
-
-    bool operands_ready() const {
-      return rs1_index == -1 && rs2_index == -1;
-    }
-
-    void update_operands(const CommonDataBus::data_t& data) {
-      // update operands if this RS entry is waiting for them
-      // TODO:
-      if (rs1_index == data.rs_index) {
-        rs1_data = data.result;
-        rs1_index = -1;
-      }
-      if (rs2_index == data.rs_index) {
-        rs2_data = data.result;
-        rs2_index = -1;
-      }
-    }
+  // a scheduler partition, FUType::NONE for the unified pool
+  struct partition_t {
+    FUType   type;
+    uint32_t base;        // first entry
+    uint32_t size;
+    uint32_t next_index;  // allocated entries
   };
 
+  // unified pool shared by all FU types
   ReservationStation(uint32_t size);
 
+  // one scheduler per FU type
+  ReservationStation(const std::vector<uint32_t>& sizes);
+
   ~ReservationStation();
 
+  bool valid(uint32_t index) const {
+    return valid_.test(index);
+  }
+
+  bool running(uint32_t index) const {
+    return valid_.test(index) && !pending_.test(index);
+  }
+
   bool operands_ready(uint32_t index) const {
     // are all operands ready?
-    // TODO:
-    return store_.at(index).operands_ready();
+    return ready_.test(index);
+  }
+
+  int rob_index(uint32_t index) const {
+    return rob_index_.at(index);
+  }
+
+  uint32_t rs1_data(uint32_t index) const {
+    return rs1_data_.at(index);
+  }
 
+  uint32_t rs2_data(uint32_t index) const {
+    return rs2_data_.at(index);
   }
 
-  const entry_t& get_entry(uint32_t index) const {
-    return store_.at(index);
+  FUType type(uint32_t index) const {
+    return type_.at(index);
   }
 
-  entry_t& get_entry(uint32_t index) {
-    return store_.at(index);
+  const Instr::Ptr& instr(uint32_t index) const {
+    return instr_.at(index);
   }
 
   int issue(int rob_index, int rs1_index, int rs2_index, uint32_t rs1_data, uint32_t rs2_data, Instr::Ptr instr);
 
+  // the entry has been assigned an FU
+  void dispatch(uint32_t index) {
+    assert(pending_.test(index));
+    pending_.reset(index);
+  }
+
+  // forward a broadcast result to the entries waiting on it
+  void wakeup(const CommonDataBus::data_t& data);
+
   void release(uint32_t index);
 
+  void discard(uint32_t index);
+
   bool locked(uint32_t index) const;
 
-  bool full() const {
-    return (next_index_ == store_.size());
+  // no free entry for an instruction of this type
+  bool full(FUType type) const {
+    auto& part = partitions_.at(part_map_[(int)type]);
+    return (part.next_index == part.size);
   }
 
-  bool empty() const {
-    return (next_index_ == 0);
+  uint32_t size() const {
+    return valid_.size();
   }
 
-  uint32_t size() const {
-    return store_.size();
+  const std::vector<partition_t>& partitions() const {
+    return partitions_;
   }
 
+  // first entry in [index, end) waiting for an FU with its operands ready, end if none
+  uint32_t select(uint32_t index, uint32_t end) const {
+    return BitVector::find_next(index, end, [&](uint32_t w) {
+      return pending_.word(w) & ready_.word(w);
+    });
+  }
+
+  // first allocated entry at or after index, size() if none
+  uint32_t next_valid(uint32_t index) const {
+    return valid_.find_next(index);
+  }
+
+  void save(CheckpointWriter& ckpt) const;
+
+  void restore(CheckpointReader& ckpt);
+
   void dump() {
-    for (uint32_t i = 0; i < store_.size(); ++i) {
-      auto& entry = store_[i];
-      if (entry.valid) {
-        DT(4, "RS[" << i << "] rob=" << entry.rob_index << ", running=" << entry.running << ", rs1=" << entry.rs1_index << ", rs2=" << entry.rs2_index << " (#" << entry.instr->getId() << ")");
-      }
+    for (uint32_t i = valid_.find_next(0); i < this->size(); i = valid_.find_next(i + 1)) {
+      DT(4, "RS[" << i << "] rob=" << rob_index_[i] << ", running=" << this->running(i) << ", rs1=" << rs1_index_[i] << ", rs2=" << rs2_index_[i] << " (#" << instr_[i]->getId() << ")");
     }
   }
 
 private:
 
-  std::vector<entry_t>  store_;
-  std::vector<uint32_t> indices_;
-  uint32_t next_index_;
-  uint32_t lsu_barrier_tick_;
-  uint32_t lsu_barrier_tock_;
+  void init(uint32_t size);
+
+  partition_t& partition(uint32_t index);
+
+  BitVector valid_;     // valid entry
+  BitVector pending_;   // valid entry not yet assigned an FU
+  BitVector ready_;     // all operands available
+  std::vector<BitVector> deps_; // entries waiting on each producer entry
+  std::vector<int> rob_index_;  // allocated ROB index
+  std::vector<int> rs1_index_;  // RS producing rs1 (-1 indicates data is already available)
+  std::vector<int> rs2_index_;  // RS producing rs2 (-1 indicates data is already available)
+  std::vector<uint32_t> rs1_data_;
+  std::vector<uint32_t> rs2_data_;
+  std::vector<uint32_t> barrier_id_; // barrier id to enforce ordering fo LSU instructions
+  std::vector<FUType> type_;
+  std::vector<Instr::Ptr> instr_;
+
+  std::vector<uint32_t> indices_;   // free lists, one segment per partition
+  std::vector<partition_t> partitions_;
+  uint32_t part_map_[NUM_FUS];      // partition of each FU type
   TicketBarrier lsu_barrier_;
 };
 
-}
\ No newline at end of file
+}
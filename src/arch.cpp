@@ -0,0 +1,397 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <stdlib.h>
+#include <util.h>
+#include <bitmanip.h>
+#include "arch.h"
+#include "BPU.h"
+
+using namespace tinyrv;
+
+namespace {
+
+struct uint_param_t {
+  const char* name;
+  uint32_t Arch::*field;
+  uint32_t min;   // smallest valid value
+  uint32_t max;   // largest valid value
+  bool pow2;      // must be a power of two
+};
+
+const uint_param_t sc_uint_params[] = {
+  {"width",             &Arch::width,               1, UINT32_MAX,       false},
+  {"fetch_buffer",      &Arch::fetch_buffer,        0, UINT32_MAX,       false},
+  {"bpred_budget",      &Arch::bpred_budget,        1, BPRED_MAX_BUDGET, false},
+  {"btb_size",          &Arch::btb_size,            1, UINT32_MAX,       true},
+  {"ras_size",          &Arch::ras_size,            1, UINT32_MAX,       true},
+  {"rob_size",          &Arch::rob_size,            1, UINT32_MAX,       false},
+  {"num_rss",           &Arch::num_rss,             1, UINT32_MAX,       false},
+  {"num_cdbs",          &Arch::num_cdbs,            1, UINT32_MAX,       false},
+  {"agu_latency",       &Arch::agu_latency,         1, UINT32_MAX,       false},
+  {"lq_size",           &Arch::lq_size,             1, UINT32_MAX,       false},
+  {"sq_size",           &Arch::sq_size,             1, UINT32_MAX,       false},
+  {"prefetch_degree",   &Arch::prefetch_degree,     1, UINT32_MAX,       false},
+  {"prefetch_distance", &Arch::prefetch_distance,   1, UINT32_MAX,       false},
+  {"mem_latency",       &Arch::mem_latency,         1, UINT32_MAX,       false},
+  {"mem_bandwidth",     &Arch::mem_bandwidth,       1, UINT32_MAX,       false},
+};
+
+// DRAM parameters, timings in DRAM clocks
+struct dram_param_t {
+  const char* name;
+  uint32_t DramConfig::*field;
+};
+
+const dram_param_t sc_dram_params[] = {
+  {"dram_row_size", &DramConfig::row_size},
+  {"dram_trcd",     &DramConfig::tRCD},
+  {"dram_trp",      &DramConfig::tRP},
+  {"dram_tcas",     &DramConfig::tCAS},
+  {"dram_tburst",   &DramConfig::tBURST},
+  {"dram_queue",    &DramConfig::queue_size},
+};
+
+// per functional unit parameters, named <unit>_<param>
+struct fu_param_t {
+  const char* name;
+  uint32_t (Arch::*field)[NUM_FUS];
+};
+
+const fu_param_t sc_fu_params[] = {
+  {"units",    &Arch::fu_units},
+  {"latency",  &Arch::fu_latency},
+  {"interval", &Arch::fu_interval},
+  {"rss",      &Arch::rs_size},
+};
+
+const char* const sc_fu_names[NUM_FUS] = {"alu", "bru", "lsu", "sfu"};
+
+bool parse_uint(const std::string& value, uint32_t* out) {
+  if (value.empty())
+    return false;
+  char* end;
+  auto num = strtoul(value.c_str(), &end, 0);
+  if (*end != '\0' || num > UINT32_MAX)
+    return false;
+  *out = num;
+  return true;
+}
+
+bool parse_bool(const std::string& value, bool* out) {
+  if (value == "1" || value == "true") {
+    *out = true;
+  } else if (value == "0" || value == "false") {
+    *out = false;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::vector<std::string> split(const std::string& value) {
+  std::vector<std::string> tokens;
+  std::stringstream ss(value);
+  for (std::string token; std::getline(ss, token, ':');) {
+    tokens.push_back(token);
+  }
+  return tokens;
+}
+
+std::string trim(const std::string& str) {
+  auto first = str.find_first_not_of(" \t\r");
+  if (first == std::string::npos)
+    return "";
+  auto last = str.find_last_not_of(" \t\r");
+  return str.substr(first, last - first + 1);
+}
+
+// <bytes>[:<ways>[:<line>[:<latency>[:<lru|fifo|random>[:<banks>[:<mshrs>]]]]]], 0 disables
+bool parse_cache(const std::string& value, CacheConfig* out) {
+  auto tokens = split(value);
+  CacheConfig config = *out;
+  bool valid = !tokens.empty() && parse_uint(tokens[0], &config.size);
+  if (valid && config.size == 0 && tokens.size() == 1) {
+    out->size = 0;
+    return true;
+  }
+  if (tokens.size() > 1) {
+    valid &= parse_uint(tokens[1], &config.ways);
+  }
+  if (tokens.size() > 2) {
+    valid &= parse_uint(tokens[2], &config.line_size);
+  }
+  if (tokens.size() > 3) {
+    valid &= parse_uint(tokens[3], &config.latency);
+  }
+  if (tokens.size() > 4) {
+    if (tokens[4] == "lru") {
+      config.repl = ReplPolicy::LRU;
+    } else if (tokens[4] == "fifo") {
+      config.repl = ReplPolicy::FIFO;
+    } else if (tokens[4] == "random") {
+      config.repl = ReplPolicy::RANDOM;
+    } else {
+      valid = false;
+    }
+  }
+  if (tokens.size() > 5) {
+    valid &= parse_uint(tokens[5], &config.banks);
+  }
+  if (tokens.size() > 6) {
+    valid &= parse_uint(tokens[6], &config.mshrs);
+  }
+  // the set count must be a power of two
+  uint32_t set_size = config.ways * config.line_size;
+  if (!valid || tokens.size() > 7 || config.ways == 0 || config.latency == 0
+   || config.banks == 0 || config.banks > 64 || !ispow2(config.banks)
+   || config.line_size < 4 || !ispow2(config.line_size)
+   || set_size == 0 || config.size % set_size != 0 || config.size == 0
+   || !ispow2(config.size / set_size))
+    return false;
+  *out = config;
+  return true;
+}
+
+void dump_cache(std::ostream& os, const CacheConfig& config) {
+  if (config.size == 0) {
+    os << 0;
+    return;
+  }
+  os << config.size << ":" << config.ways << ":" << config.line_size << ":" << config.latency
+     << ":" << config.repl << ":" << config.banks << ":" << config.mshrs;
+}
+
+}
+
+bool Arch::set(const std::string& key, const std::string& value) {
+  for (auto& param : sc_uint_params) {
+    if (key != param.name)
+      continue;
+    uint32_t num;
+    if (!parse_uint(value, &num) || num < param.min || num > param.max
+     || (param.pow2 && !ispow2(num)))
+      return false;
+    this->*param.field = num;
+    return true;
+  }
+
+  for (auto& param : sc_dram_params) {
+    if (key != param.name)
+      continue;
+    uint32_t num;
+    if (!parse_uint(value, &num) || num == 0)
+      return false;
+    dram.*param.field = num;
+    return true;
+  }
+
+  for (auto& param : sc_fu_params) {
+    for (uint32_t i = 0; i < NUM_FUS; ++i) {
+      if (key != std::string(sc_fu_names[i]) + "_" + param.name)
+        continue;
+      uint32_t num;
+      if (!parse_uint(value, &num) || num == 0)
+        return false;
+      (this->*param.field)[i] = num;
+      if (param.field == &Arch::fu_latency && i != (uint32_t)FUType::LSU) {
+        fu_interval[i] = num;
+      }
+      return true;
+    }
+  }
+
+  if (key == "prf_size") {
+    // the architectural state alone takes NUM_REGS registers
+    uint32_t num;
+    if (!parse_uint(value, &num) || (num != 0 && num <= NUM_REGS))
+      return false;
+    prf_size = num;
+  } else if (key == "bpred") {
+    if (value == "none") {
+      bpred = BPredType::NONE;
+    } else if (value == "bimodal") {
+      bpred = BPredType::BIMODAL;
+    } else if (value == "gshare") {
+      bpred = BPredType::GSHARE;
+    } else if (value == "tage") {
+      bpred = BPredType::TAGE;
+    } else if (value == "perceptron") {
+      bpred = BPredType::PERCEPTRON;
+    } else {
+      return false;
+    }
+  } else if (key == "cdb_arb") {
+    if (value == "fixed") {
+      cdb_arb = CDBArbType::FIXED;
+    } else if (value == "oldest") {
+      cdb_arb = CDBArbType::OLDEST;
+    } else if (value == "rr") {
+      cdb_arb = CDBArbType::ROUND_ROBIN;
+    } else {
+      return false;
+    }
+  } else if (key == "rs_select") {
+    if (value == "index") {
+      rs_select = RSSelectType::INDEX;
+    } else if (value == "oldest") {
+      rs_select = RSSelectType::OLDEST;
+    } else {
+      return false;
+    }
+  } else if (key == "dprefetch") {
+    if (value == "none") {
+      dprefetch = PrefetchType::NONE;
+    } else if (value == "stride") {
+      dprefetch = PrefetchType::STRIDE;
+    } else if (value == "stream") {
+      dprefetch = PrefetchType::STREAM;
+    } else {
+      return false;
+    }
+  } else if (key == "distributed_rs") {
+    return parse_bool(value, &distributed_rs);
+  } else if (key == "lsq") {
+    return parse_bool(value, &lsq);
+  } else if (key == "timed_memory") {
+    return parse_bool(value, &timed_memory);
+  } else if (key == "l1i_prefetch") {
+    return parse_bool(value, &l1i.prefetch);
+  } else if (key == "l1d") {
+    return parse_cache(value, &l1d);
+  } else if (key == "l1i") {
+    return parse_cache(value, &l1i);
+  } else if (key == "l2") {
+    return parse_cache(value, &l2);
+  } else if (key == "dram") {
+    // <channels>[:<banks>], the DRAM model is part of the timed memory path
+    auto tokens = split(value);
+    auto config = dram;
+    if (tokens.empty() || tokens.size() > 2 || !parse_uint(tokens[0], &config.channels))
+      return false;
+    if (tokens.size() > 1 && (!parse_uint(tokens[1], &config.banks) || config.banks == 0))
+      return false;
+    dram = config;
+    timed_memory |= (dram.channels != 0);
+  } else if (key == "mem_cycle_ratio") {
+    // core cycles per DRAM clock, -n for a DRAM clock n times faster
+    char* end;
+    long num = strtol(value.c_str(), &end, 0);
+    if (value.empty() || *end != '\0' || num == 0 || num < INT32_MIN || num > INT32_MAX)
+      return false;
+    dram.cycle_ratio = num;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+bool Arch::load(const char* path) {
+  std::ifstream ifs(path);
+  if (!ifs) {
+    std::cout << "error: " << path << " not found" << std::endl;
+    return false;
+  }
+  uint32_t line_no = 0;
+  for (std::string line; std::getline(ifs, line);) {
+    ++line_no;
+    line = trim(line.substr(0, line.find('#')));
+    if (line.empty())
+      continue;
+    auto pos = line.find('=');
+    if (pos == std::string::npos
+     || !this->set(trim(line.substr(0, pos)), trim(line.substr(pos + 1)))) {
+      std::cout << "error: " << path << ":" << line_no << ": invalid parameter " << line << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Arch::check(std::ostream& os) const {
+  // prefetched blocks go to the first data cache level
+  if (dprefetch != PrefetchType::NONE && l1d.size == 0 && l2.size == 0) {
+    os << "error: the data prefetcher requires a data cache" << std::endl;
+    return false;
+  }
+  // without the LSQ memory instructions are serialized on a single LSU
+  if (!lsq && (fu_units[(int)FUType::LSU] != 1 || fu_interval[(int)FUType::LSU] != 1)) {
+    os << "error: several or pipelined LSUs require the load/store queue" << std::endl;
+    return false;
+  }
+  if (!lsq && (lq_size != LQ_SIZE || sq_size != SQ_SIZE)) {
+    os << "error: load/store queue sizes require the load/store queue" << std::endl;
+    return false;
+  }
+  // an L2 line holds whole L1 lines
+  for (auto l1 : {&l1d, &l1i}) {
+    if (l2.size != 0 && l1->size != 0 && l2.line_size < l1->line_size) {
+      os << "error: the L2 line is smaller than an L1 line" << std::endl;
+      return false;
+    }
+  }
+  // every in-flight branch pushes a history bit, commit trains on the
+  // longest history behind the oldest one, which must not be overwritten
+  if (this->speculative()) {
+    uint64_t in_flight = uint64_t(rob_size) + width + (fetch_buffer ? fetch_buffer : width);
+    uint32_t max_history = std::max(TAGE_MAX_HISTORY, ITTAGE_MAX_HISTORY);
+    if (in_flight + max_history >= BranchHistory::Size) {
+      os << "error: the ROB and front-end queues exceed the " << (BranchHistory::Size - max_history - 1)
+         << " in-flight instructions the branch history supports" << std::endl;
+      return false;
+    }
+  }
+  // a DRAM row holds whole memory blocks
+  if (dram.channels != 0 && (dram.row_size < MEM_BLOCK_SIZE || dram.row_size % MEM_BLOCK_SIZE != 0)) {
+    os << "error: the DRAM row size must be a multiple of " << MEM_BLOCK_SIZE << " bytes" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+void Arch::dump(std::ostream& os) const {
+  const char* sep = "";
+  for (auto& param : sc_uint_params) {
+    os << sep << param.name << "=" << this->*param.field;
+    sep = ", ";
+  }
+  for (auto& param : sc_fu_params) {
+    for (uint32_t i = 0; i < NUM_FUS; ++i) {
+      os << sep << sc_fu_names[i] << "_" << param.name << "=" << (this->*param.field)[i];
+    }
+  }
+  os << sep << "prf_size=" << prf_size
+     << sep << "bpred=" << bpred
+     << sep << "cdb_arb=" << cdb_arb
+     << sep << "rs_select=" << rs_select
+     << sep << "dprefetch=" << dprefetch
+     << sep << "distributed_rs=" << distributed_rs
+     << sep << "lsq=" << lsq
+     << sep << "timed_memory=" << timed_memory
+     << sep << "l1i_prefetch=" << l1i.prefetch;
+  os << sep << "l1d=";
+  dump_cache(os, l1d);
+  os << sep << "l1i=";
+  dump_cache(os, l1i);
+  os << sep << "l2=";
+  dump_cache(os, l2);
+  os << sep << "dram=" << dram.channels << ":" << dram.banks;
+  for (auto& param : sc_dram_params) {
+    os << sep << param.name << "=" << dram.*param.field;
+  }
+  os << sep << "mem_cycle_ratio=" << dram.cycle_ratio;
+}
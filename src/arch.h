@@ -0,0 +1,126 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <iosfwd>
+#include "config.h"
+#include "types.h"
+
+namespace tinyrv {
+
+// microarchitecture parameters selected at runtime,
+// defaults come from config.h
+// Each parameter has a name, used by config files, -O overrides and the
+// CONFIG stats line; composite ones (caches, DRAM) take the CLI syntax.
+struct Arch {
+  BPredType bpred;       // branch predictor, fetch speculates past branches unless none
+  uint32_t bpred_budget;  // branch predictor storage (bytes)
+  uint32_t width;         // instructions fetched, decoded, issued and committed per cycle
+  uint32_t btb_size;      // branch target buffer entries
+  uint32_t ras_size;      // return address stack entries
+  uint32_t rob_size;      // reorder buffer entries
+  uint32_t num_cdbs;      // results broadcast per cycle
+  CDBArbType cdb_arb;     // result bus arbitration
+  uint32_t fu_units[NUM_FUS];    // functional units per FUType
+  uint32_t fu_latency[NUM_FUS];  // execution latency per FUType (cycles), the LSU's is the memory's without a data cache
+  uint32_t fu_interval[NUM_FUS]; // initiation interval per FUType (cycles), the LSU's only with the LSQ
+  uint32_t agu_latency;          // address generation, also a load forwarded from a store
+  uint32_t num_rss;              // scheduler entries when unified
+  bool     distributed_rs;       // one scheduler per FUType instead of a unified pool
+  uint32_t rs_size[NUM_FUS];     // scheduler entries per FUType when distributed
+  RSSelectType rs_select;        // order ready instructions are selected in
+  uint32_t prf_size;      // merged physical register file entries, 0 renames to the ROB
+  bool     lsq;           // load/store queue instead of serialized memory instructions
+  uint32_t lq_size;       // load queue entries
+  uint32_t sq_size;       // store queue entries
+  CacheConfig l1d;        // L1 data cache, data accesses take the LSU latency without it
+  CacheConfig l1i;        // L1 instruction cache, fetch reads memory directly without it
+  CacheConfig l2;         // L2 cache shared by the L1s, or by the core without them
+  PrefetchType dprefetch; // data prefetcher, filling the first data cache level
+  uint32_t prefetch_degree;   // blocks prefetched per trigger
+  uint32_t prefetch_distance; // strides or lines between the load and the first prefetch
+  uint32_t fetch_buffer;  // fetched instructions awaiting decode, 0 uses the width
+  bool     timed_memory;  // route fetch and data accesses through the memory model
+  uint32_t mem_latency;   // memory access latency (cycles)
+  uint32_t mem_bandwidth; // memory requests accepted per cycle
+  DramConfig dram;        // DRAM timing model replacing the fixed memory latency
+
+  Arch()
+    : bpred(BPredType::NONE)
+    , bpred_budget(BPRED_BUDGET)
+    , width(PIPELINE_WIDTH)
+    , btb_size(BTB_SIZE)
+    , ras_size(RAS_SIZE)
+    , rob_size(ROB_SIZE)
+    , num_cdbs(NUM_CDBS)
+    , cdb_arb(CDBArbType::FIXED)
+    , agu_latency(AGU_LATENCY)
+    , num_rss(NUM_RSS)
+    , distributed_rs(false)
+    , rs_select(RSSelectType::INDEX)
+    , prf_size(0)
+    , lsq(false)
+    , lq_size(LQ_SIZE)
+    , sq_size(SQ_SIZE)
+    , l1d({0, L1D_WAYS, L1D_LINE_SIZE, L1D_LATENCY, ReplPolicy::LRU, false, 1, 0})
+    , l1i({0, L1I_WAYS, L1I_LINE_SIZE, L1I_LATENCY, ReplPolicy::LRU, false, 1, 0})
+    , l2({0, L2_WAYS, L2_LINE_SIZE, L2_LATENCY, ReplPolicy::LRU, false, L2_BANKS, L2_MSHRS})
+    , dprefetch(PrefetchType::NONE)
+    , prefetch_degree(PREFETCH_DEGREE)
+    , prefetch_distance(PREFETCH_DISTANCE)
+    , fetch_buffer(0)
+    , timed_memory(false)
+    , mem_latency(MEM_LATENCY)
+    , mem_bandwidth(MEM_BANDWIDTH)
+    , dram({0, DRAM_BANKS, DRAM_ROW_SIZE, DRAM_TRCD, DRAM_TRP, DRAM_TCAS, DRAM_TBURST, DRAM_QUEUE_SIZE, MEM_CYCLE_RATIO})
+  {
+    fu_units[(int)FUType::ALU] = NUM_ALUS;
+    fu_units[(int)FUType::BRU] = NUM_BRUS;
+    fu_units[(int)FUType::LSU] = 1;
+    fu_units[(int)FUType::SFU] = NUM_SFUS;
+    fu_latency[(int)FUType::ALU] = ALU_LATENCY;
+    fu_latency[(int)FUType::BRU] = BRU_LATENCY;
+    fu_latency[(int)FUType::LSU] = LSU_LATENCY;
+    fu_latency[(int)FUType::SFU] = SFU_LATENCY;
+    fu_interval[(int)FUType::ALU] = ALU_INTERVAL;
+    fu_interval[(int)FUType::BRU] = BRU_INTERVAL;
+    fu_interval[(int)FUType::LSU] = 1;
+    fu_interval[(int)FUType::SFU] = SFU_INTERVAL;
+    rs_size[(int)FUType::ALU] = ALU_RSS;
+    rs_size[(int)FUType::BRU] = BRU_RSS;
+    rs_size[(int)FUType::LSU] = LSU_RSS;
+    rs_size[(int)FUType::SFU] = SFU_RSS;
+  }
+
+  bool speculative() const {
+    return bpred != BPredType::NONE;
+  }
+
+  // set a parameter from its text value, false if unknown or invalid;
+  // a latency also sets the unit's interval, as in config.h,
+  // except the LSU's: it is pipelined with the LSQ, serialized without
+  bool set(const std::string& key, const std::string& value);
+
+  // apply the "key = value" lines of a config file, '#' starts a comment
+  bool load(const char* path);
+
+  // constraints across parameters, prints the first one violated to os
+  bool check(std::ostream& os) const;
+
+  // effective parameters as "key=value" pairs
+  void dump(std::ostream& os) const;
+};
+
+}
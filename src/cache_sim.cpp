@@ -0,0 +1,339 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <assert.h>
+#include <util.h>
+#include <bitmanip.h>
+#include "debug.h"
+#include "cache_sim.h"
+
+using namespace tinyrv;
+
+// tag of the fills answering writebacks, they are dropped
+static const uint32_t WRITEBACK_TAG = 0xffffffff;
+
+CacheSim::CacheSim(const SimContext& ctx,
+                   const char* name,
+                   uint32_t num_ports,
+                   const CacheConfig& config,
+                   uint32_t miss_latency)
+  : SimObject<CacheSim>(ctx, name)
+  , req_ports(num_ports, this)
+  , rsp_ports(num_ports, this)
+  , mem_req_port(this)
+  , mem_rsp_port(this)
+  , config_(config)
+  , miss_latency_(miss_latency)
+  , next_level_(nullptr)
+  , num_sets_(config.size / (config.ways * config.line_size))
+  , line_bits_(log2ceil(config.line_size))
+  , lines_(config.size / config.line_size)
+{
+  assert(config.latency != 0);
+  assert(ispow2(config.line_size));
+  assert(num_sets_ != 0 && ispow2(num_sets_));
+  assert(ispow2(config.banks) && config.banks <= 64);
+  this->reset();
+}
+
+CacheSim::~CacheSim() {}
+
+void CacheSim::reset() {
+  for (auto& line : lines_) {
+    line = {false, false, false, 0, 0, 0};
+  }
+  misses_.clear();
+  stamp_ = 0;
+  rand_ = 1;
+  fill_id_ = 0;
+  rr_index_ = 0;
+  bank_accesses_.assign(config_.banks, 0);
+  perf_stats_ = PerfStats();
+}
+
+void CacheSim::tick() {
+  // install the returning fills and answer their requests
+  while (!mem_rsp_port.empty()) {
+    auto& mem_rsp = mem_rsp_port.front();
+    for (auto it = misses_.begin(); it != misses_.end(); ++it) {
+      if (it->id != mem_rsp.tag)
+        continue;
+      DT(3, this->name() << "-fill: addr=0x" << std::hex << (it->line_addr << line_bits_) << std::dec);
+      auto& line = this->fill(it->line_addr, it->dirty, it->req);
+      line.prefetched = it->prefetch;
+      for (auto& request : it->requests) {
+        rsp_ports.at(request.port).send(MemRsp{request.req.tag, request.req.cid, request.req.uuid}, 1);
+      }
+      misses_.erase(it);
+      break;
+    }
+    mem_rsp_port.pop();
+  }
+
+  // one lookup per bank, ports served in round-robin order
+  uint32_t num_ports = req_ports.size();
+  uint64_t busy_banks = 0;
+  bool served = false;
+  for (uint32_t i = 0; i < num_ports; ++i) {
+    uint32_t p = (rr_index_ + i) % num_ports;
+    auto& req_port = req_ports.at(p);
+    if (req_port.empty())
+      continue;
+    auto& req = req_port.front();
+    uint32_t bank = (req.addr >> line_bits_) & (config_.banks - 1);
+    if (busy_banks & (1ull << bank)) {
+      ++perf_stats_.bank_conflicts;
+      continue;
+    }
+    busy_banks |= (1ull << bank);
+    ++bank_accesses_.at(bank);
+    if (!this->lookup_request(p, req)) {
+      ++perf_stats_.mshr_stalls;
+      continue;
+    }
+    if (config_.prefetch) {
+      this->prefetch_line((req.addr >> line_bits_) + 1, req);
+    }
+    req_port.pop();
+    if (!served) {
+      rr_index_ = (p + 1) % num_ports;
+      served = true;
+    }
+  }
+
+  perf_stats_.mshr_occupancy += misses_.size();
+}
+
+bool CacheSim::lookup_request(uint32_t port, const MemReq& req) {
+  // a new miss needs a free MSHR
+  uint64_t line_addr = req.addr >> line_bits_;
+  if (config_.mshrs != 0 && misses_.size() >= config_.mshrs
+   && !this->present(line_addr) && !this->find_miss(line_addr))
+    return false;
+
+  DT(3, this->name() << "-" << req);
+  if (req.write) {
+    ++perf_stats_.writes;
+  } else {
+    ++perf_stats_.reads;
+  }
+
+  auto line = this->lookup(line_addr);
+  if (line) {
+    line->dirty |= req.write;
+    if (line->prefetched) {
+      line->prefetched = false;
+      ++perf_stats_.prefetch_hits;
+    }
+    rsp_ports.at(port).send(MemRsp{req.tag, req.cid, req.uuid}, config_.latency);
+    return true;
+  }
+
+  ++perf_stats_.misses;
+  auto miss = this->find_miss(line_addr);
+  if (miss) {
+    if (miss->prefetch) {
+      miss->prefetch = false;
+      ++perf_stats_.prefetch_late;
+    }
+    miss->dirty |= req.write;
+    miss->requests.push_back({port, req});
+    ++perf_stats_.merged;
+    return true;
+  }
+  uint32_t id = fill_id_++;
+  misses_.push_back({line_addr, id, req.write, false, req, {{port, req}}});
+  mem_req_port.send(MemReq{line_addr << line_bits_, false, id, req.cid, req.uuid}, config_.latency);
+  return true;
+}
+
+void CacheSim::prefetch(uint64_t addr) {
+  this->prefetch_line(addr >> line_bits_, MemReq{addr, false, 0, 0, 0});
+}
+
+void CacheSim::prefetch_line(uint64_t line_addr, const MemReq& req) {
+  // fetch a line neither present nor already being filled
+  if (this->present(line_addr))
+    return;
+  if (!mem_req_port.connected()) {
+    auto& line = this->fill(line_addr, false, req);
+    line.prefetched = true;
+    line.ready = this->platform().cycles() + config_.latency + this->miss_latency(line_addr << line_bits_);
+    ++perf_stats_.prefetches;
+    return;
+  }
+  if (this->find_miss(line_addr))
+    return;
+  // prefetches only use spare MSHRs
+  if (config_.mshrs != 0 && misses_.size() >= config_.mshrs)
+    return;
+  ++perf_stats_.prefetches;
+  uint32_t id = fill_id_++;
+  misses_.push_back({line_addr, id, false, true, req, {}});
+  mem_req_port.send(MemReq{line_addr << line_bits_, false, id, req.cid, req.uuid}, config_.latency);
+}
+
+uint32_t CacheSim::access(uint64_t addr, bool write) {
+  if (write) {
+    ++perf_stats_.writes;
+  } else {
+    ++perf_stats_.reads;
+  }
+  uint64_t now = this->platform().cycles();
+  uint64_t line_addr = addr >> line_bits_;
+  uint32_t latency = config_.latency;
+  auto line = this->lookup(line_addr);
+  if (line) {
+    // a line still being filled counts as a merged miss
+    bool filling = (line->ready > now + latency);
+    line->dirty |= write;
+    if (line->prefetched) {
+      line->prefetched = false;
+      if (filling) {
+        ++perf_stats_.prefetch_late;
+      } else {
+        ++perf_stats_.prefetch_hits;
+      }
+    }
+    if (filling) {
+      ++perf_stats_.misses;
+      ++perf_stats_.merged;
+      latency = line->ready - now;
+    }
+  } else {
+    ++perf_stats_.misses;
+    latency += this->miss_latency(addr);
+    auto& fill = this->fill(line_addr, write, MemReq{addr, write, 0, 0, 0});
+    fill.ready = now + latency;
+  }
+  if (config_.prefetch) {
+    this->prefetch_line(line_addr + 1, MemReq{addr, false, 0, 0, 0});
+  }
+  return latency;
+}
+
+uint32_t CacheSim::miss_latency(uint64_t addr) {
+  if (next_level_)
+    return next_level_->access(addr, false);
+  return miss_latency_;
+}
+
+bool CacheSim::present(uint64_t line_addr) const {
+  uint32_t set = line_addr & (num_sets_ - 1);
+  auto ways = &lines_[set * config_.ways];
+  for (uint32_t i = 0; i < config_.ways; ++i) {
+    if (ways[i].valid && ways[i].tag == line_addr)
+      return true;
+  }
+  return false;
+}
+
+CacheSim::miss_t* CacheSim::find_miss(uint64_t line_addr) {
+  for (auto& miss : misses_) {
+    if (miss.line_addr == line_addr)
+      return &miss;
+  }
+  return nullptr;
+}
+
+CacheSim::line_t* CacheSim::lookup(uint64_t line_addr) {
+  uint32_t set = line_addr & (num_sets_ - 1);
+  auto ways = &lines_[set * config_.ways];
+  for (uint32_t i = 0; i < config_.ways; ++i) {
+    auto& line = ways[i];
+    if (line.valid && line.tag == line_addr) {
+      if (config_.repl == ReplPolicy::LRU) {
+        line.stamp = ++stamp_;
+      }
+      return &line;
+    }
+  }
+  return nullptr;
+}
+
+CacheSim::line_t& CacheSim::fill(uint64_t line_addr, bool dirty, const MemReq& req) {
+  // pick a free way, else the victim of the replacement policy
+  uint32_t set = line_addr & (num_sets_ - 1);
+  auto ways = &lines_[set * config_.ways];
+  line_t* victim = nullptr;
+  for (uint32_t i = 0; i < config_.ways && !victim; ++i) {
+    if (!ways[i].valid) {
+      victim = &ways[i];
+    }
+  }
+  if (!victim) {
+    if (config_.repl == ReplPolicy::RANDOM) {
+      rand_ ^= rand_ << 13;
+      rand_ ^= rand_ >> 17;
+      rand_ ^= rand_ << 5;
+      victim = &ways[rand_ % config_.ways];
+    } else {
+      victim = &ways[0];
+      for (uint32_t i = 1; i < config_.ways; ++i) {
+        if (ways[i].stamp < victim->stamp) {
+          victim = &ways[i];
+        }
+      }
+    }
+    if (victim->dirty) {
+      ++perf_stats_.writebacks;
+      if (mem_req_port.connected()) {
+        mem_req_port.send(MemReq{victim->tag << line_bits_, true, WRITEBACK_TAG, req.cid, req.uuid}, 1);
+      } else if (next_level_) {
+        next_level_->access(victim->tag << line_bits_, true);
+      }
+    }
+  }
+  *victim = {true, dirty, false, line_addr, ++stamp_, 0};
+  return *victim;
+}
+
+uint64_t CacheSim::idle_cycles() const {
+  if (!mem_rsp_port.empty())
+    return 0;
+  for (auto& req_port : req_ports) {
+    if (!req_port.empty())
+      return 0;
+  }
+  // woken up by the next request or fill event
+  return UINT64_MAX;
+}
+
+void CacheSim::skip(uint64_t cycles) {
+  perf_stats_.mshr_occupancy += misses_.size() * cycles;
+}
+
+void CacheSim::save(CheckpointWriter& ckpt) const {
+  for (auto& req_port : req_ports) {
+    req_port.save(ckpt);
+  }
+  for (auto& rsp_port : rsp_ports) {
+    rsp_port.save(ckpt);
+  }
+  mem_req_port.save(ckpt);
+  mem_rsp_port.save(ckpt);
+  ckpt << lines_ << misses_ << stamp_ << rand_ << fill_id_ << rr_index_ << bank_accesses_ << perf_stats_;
+}
+
+void CacheSim::restore(CheckpointReader& ckpt) {
+  for (auto& req_port : req_ports) {
+    req_port.restore(ckpt);
+  }
+  for (auto& rsp_port : rsp_ports) {
+    rsp_port.restore(ckpt);
+  }
+  mem_req_port.restore(ckpt);
+  mem_rsp_port.restore(ckpt);
+  ckpt >> lines_ >> misses_ >> stamp_ >> rand_ >> fill_id_ >> rr_index_ >> bank_accesses_ >> perf_stats_;
+}
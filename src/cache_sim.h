@@ -0,0 +1,179 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+#include <simobject.h>
+#include "types.h"
+
+namespace tinyrv {
+
+// Set-associative write-back, write-allocate cache timing model.
+// Only tags are kept, data is accessed functionally by the requester.
+// Lines are interleaved across banks, each bank looks up one request per
+// cycle and requests arriving together on the same bank conflict. A hit
+// is answered after the hit latency; a miss takes an MSHR and sends a
+// line fill to the next level, it is answered when the fill returns and
+// later misses to the same line wait on that fill. A miss finding every
+// MSHR busy is retried. Dirty victims are written back to the next level.
+// Without a memory model, access() looks up the tags immediately and
+// returns the access latency, a miss costing the next level's access or
+// miss_latency more; lines remember when their fill completes so later
+// accesses wait for it. Banks and MSHRs are only modeled with ports.
+// Next-line prefetch fetches the line following each accessed one.
+class CacheSim : public SimObject<CacheSim> {
+public:
+  struct PerfStats {
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t misses;
+    uint64_t merged;     // misses to a line already being filled
+    uint64_t writebacks;
+    uint64_t prefetches;
+    uint64_t prefetch_hits; // prefetched lines accessed after their fill
+    uint64_t prefetch_late; // prefetched lines accessed while being filled
+    uint64_t bank_conflicts; // lookups delayed by another on the same bank
+    uint64_t mshr_stalls;    // lookups delayed by all MSHRs busy
+    uint64_t mshr_occupancy; // fills in flight summed over cycles
+
+    PerfStats()
+      : reads(0)
+      , writes(0)
+      , misses(0)
+      , merged(0)
+      , writebacks(0)
+      , prefetches(0)
+      , prefetch_hits(0)
+      , prefetch_late(0)
+      , bank_conflicts(0)
+      , mshr_stalls(0)
+      , mshr_occupancy(0)
+    {}
+  };
+
+  std::vector<SimPort<MemReq>> req_ports;
+  std::vector<SimPort<MemRsp>> rsp_ports;
+
+  SimPort<MemReq> mem_req_port;
+  SimPort<MemRsp> mem_rsp_port;
+
+  CacheSim(const SimContext& ctx,
+           const char* name,
+           uint32_t num_ports,
+           const CacheConfig& config,
+           uint32_t miss_latency);
+
+  ~CacheSim();
+
+  void reset();
+
+  void tick();
+
+  uint64_t idle_cycles() const;
+
+  void skip(uint64_t cycles);
+
+  void save(CheckpointWriter& ckpt) const;
+
+  void restore(CheckpointReader& ckpt);
+
+  // untimed lookup, returns the access latency
+  uint32_t access(uint64_t addr, bool write);
+
+  // fetch a block ahead of its use, unless present or in flight
+  void prefetch(uint64_t addr);
+
+  // level missed into by untimed lookups
+  void set_next_level(CacheSim* cache) {
+    next_level_ = cache;
+  }
+
+  const CacheConfig& config() const {
+    return config_;
+  }
+
+  const PerfStats& perf_stats() const {
+    return perf_stats_;
+  }
+
+  // lookups performed by each bank
+  const std::vector<uint64_t>& bank_accesses() const {
+    return bank_accesses_;
+  }
+
+private:
+
+  struct line_t {
+    bool     valid;
+    bool     dirty;
+    bool     prefetched; // filled by a prefetch, not accessed yet
+    uint64_t tag;
+    uint64_t stamp;      // last use (LRU) or fill (FIFO) order
+    uint64_t ready;      // fill completion cycle (untimed)
+  };
+
+  struct request_t {
+    uint32_t port;
+    MemReq   req;
+  };
+
+  // a line fill in flight and the requests waiting on it,
+  // none for a prefetch
+  struct miss_t {
+    uint64_t line_addr;
+    uint32_t id;
+    bool     dirty;
+    bool     prefetch; // sent by a prefetch, no request yet
+    MemReq   req;      // request that caused the fill
+    std::vector<request_t> requests;
+
+    friend CheckpointWriter& operator<<(CheckpointWriter& ckpt, const miss_t& miss) {
+      return ckpt << miss.line_addr << miss.id << miss.dirty << miss.prefetch << miss.req << miss.requests;
+    }
+
+    friend CheckpointReader& operator>>(CheckpointReader& ckpt, miss_t& miss) {
+      return ckpt >> miss.line_addr >> miss.id >> miss.dirty >> miss.prefetch >> miss.req >> miss.requests;
+    }
+  };
+
+  line_t* lookup(uint64_t line_addr);
+
+  bool present(uint64_t line_addr) const;
+
+  miss_t* find_miss(uint64_t line_addr);
+
+  uint32_t miss_latency(uint64_t addr);
+
+  line_t& fill(uint64_t line_addr, bool dirty, const MemReq& req);
+
+  bool lookup_request(uint32_t port, const MemReq& req);
+
+  void prefetch_line(uint64_t line_addr, const MemReq& req);
+
+  CacheConfig config_;
+  uint32_t miss_latency_;
+  CacheSim* next_level_;
+  uint32_t num_sets_;
+  uint32_t line_bits_;
+  std::vector<line_t> lines_;
+  std::vector<miss_t> misses_;
+  uint64_t stamp_;
+  uint32_t rand_;
+  uint32_t fill_id_;
+  uint32_t rr_index_;
+  std::vector<uint64_t> bank_accesses_;
+  PerfStats perf_stats_;
+};
+
+}
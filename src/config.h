@@ -17,19 +17,85 @@
 
 #define NUM_FUS 4
 
+#define PIPELINE_WIDTH 1
+
 #define ALU_LATENCY 2
 #define BRU_LATENCY 2
 #define LSU_LATENCY 50
 #define SFU_LATENCY 3
 
-#define CDB_LATENCY 2
+#define NUM_ALUS 1
+#define NUM_BRUS 1
+#define NUM_SFUS 1
+
+// initiation intervals, 1 for a fully pipelined unit
+#define ALU_INTERVAL ALU_LATENCY
+#define BRU_INTERVAL BRU_LATENCY
+#define SFU_INTERVAL SFU_LATENCY
+
+#define NUM_CDBS 1
 
 #define NUM_RSS 8
 
+// scheduler entries per FU type in distributed mode
+#define ALU_RSS 3
+#define BRU_RSS 2
+#define LSU_RSS 2
+#define SFU_RSS 1
+
 #define ROB_SIZE 16
 
+#define LQ_SIZE 8
+#define SQ_SIZE 8
+
+// address generation, also the latency of a load forwarded from a store
+#define AGU_LATENCY 1
+
+#define L1D_WAYS 4
+#define L1D_LINE_SIZE MEM_BLOCK_SIZE
+#define L1D_LATENCY 2
+
+// a hit is as fast as fetching without the cache
+#define L1I_WAYS 4
+#define L1I_LINE_SIZE MEM_BLOCK_SIZE
+#define L1I_LATENCY 1
+
+// shared by instruction and data misses
+#define L2_WAYS 8
+#define L2_LINE_SIZE MEM_BLOCK_SIZE
+#define L2_LATENCY 10
+#define L2_BANKS MEMORY_BANKS
+#define L2_MSHRS 8
+
+// data prefetcher, distance counted in strides or lines ahead
+#define PREFETCH_DEGREE 2
+#define PREFETCH_DISTANCE 4
+#define PREFETCH_TABLE_SIZE 64
+#define PREFETCH_STREAMS 8
+#define PREFETCH_STREAM_WINDOW 4
+
 #define NUM_REGS 32
 
+#define BPRED_BUDGET 1024
+
+// largest runtime budget (bytes), tables are sized from it
+#define BPRED_MAX_BUDGET (1024 * 1024)
+
+#define BTB_SIZE 256
+
+#define TAGE_NUM_TABLES 6
+#define TAGE_MIN_HISTORY 4
+#define TAGE_MAX_HISTORY 128
+#define TAGE_TAG_BITS 9
+
+#define RAS_SIZE 16
+
+#define ITTAGE_NUM_TABLES 4
+#define ITTAGE_TABLE_SIZE 128
+#define ITTAGE_MIN_HISTORY 4
+#define ITTAGE_MAX_HISTORY 64
+#define ITTAGE_TAG_BITS 9
+
 #ifndef DEBUG_LEVEL
 #define DEBUG_LEVEL 3
 #endif
@@ -38,10 +104,35 @@
 #define RAM_PAGE_SIZE 4096
 #endif
 
+#ifndef MEM_LATENCY
+#define MEM_LATENCY 50
+#endif
+
+#ifndef MEM_BANDWIDTH
+#define MEM_BANDWIDTH 1
+#endif
+
+// core cycles per DRAM clock, -n for a DRAM clock n times faster
 #ifndef MEM_CYCLE_RATIO
 #define MEM_CYCLE_RATIO -1
 #endif
 
+#ifndef DRAM_BANKS
+#define DRAM_BANKS 8
+#endif
+
+#ifndef DRAM_ROW_SIZE
+#define DRAM_ROW_SIZE 2048
+#endif
+
+// DRAM timings in DRAM clocks
+#define DRAM_TRCD 16
+#define DRAM_TRP 16
+#define DRAM_TCAS 16
+#define DRAM_TBURST 4
+
+#define DRAM_QUEUE_SIZE 16
+
 #ifndef MEMORY_BANKS
 #define MEMORY_BANKS 2
 #endif
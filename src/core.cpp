@@ -13,6 +13,7 @@
 
 #include <iostream>
 #include <iomanip>
+#include <sstream>
 #include <string.h>
 #include <assert.h>
 #include <util.h>
@@ -23,25 +24,57 @@
 
 using namespace tinyrv;
 
-Core::Core(const SimContext& ctx, uint32_t core_id, ProcessorImpl* processor)
+// RISC-V link registers x1 and x5 mark calls and returns
+static bool is_link(uint32_t reg) {
+  return reg == 1 || reg == 5;
+}
+
+static bool is_return(uint32_t rd, uint32_t rs1) {
+  return is_link(rs1) && !(is_link(rd) && rd == rs1);
+}
+
+Core::Core(const SimContext& ctx, uint32_t core_id, ProcessorImpl* processor, const Arch& arch)
     : SimObject(ctx, "core")
+    , imem_req_port(this)
+    , imem_rsp_port(this)
+    , dmem_req_port(this)
+    , dmem_rsp_port(this)
     , core_id_(core_id)
     , processor_(processor)
+    , arch_(arch)
     , reg_file_(NUM_REGS)
-    , decode_queue_(FiFoReg<id_data_t>::Create("idq"))
-    , issue_queue_(FiFoReg<is_data_t>::Create("isq"))
-    , fetch_stalled_(ValReg<bool>::Create("fetch_stalled", false))
-    , ROB_(ROB_SIZE/*TODO: use size info from config.h*/)
+    , decode_queue_(DecodeQueue::Create(ctx.platform(), "idq", arch.fetch_buffer ? arch.fetch_buffer : arch.width))
+    , issue_queue_(IssueQueue::Create(ctx.platform(), "isq", arch.width))
+    , fetch_stalled_(ValReg<bool>::Create(ctx.platform(), "fetch_stalled", false))
+    , ROB_(arch.rob_size)
     , RAT_(NUM_REGS/*TODO: use size info from config.h*/)
-    , RS_(NUM_RSS/*TODO: use size info from config.h*/)
-    , RST_(ROB_SIZE/*TODO: use size info from config.h*/)
-    , FUs_(NUM_FUS/*TODO: use size info from config.h*/)
+    , PRF_(arch.prf_size, NUM_REGS)
+    , RS_(arch.distributed_rs ? ReservationStation(std::vector<uint32_t>(arch.rs_size, arch.rs_size + NUM_FUS))
+                              : ReservationStation(arch.num_rss))
+    , RST_(arch.rob_size)
+    , CDB_(arch.num_cdbs)
+    , LSQ_(arch.lq_size, arch.sq_size)
+    , BTB_(arch.btb_size)
+    , RAS_(arch.ras_size)
+    , dcache_(nullptr)
+    , icache_(nullptr)
+    , prefetcher_(arch.dprefetch, arch.prefetch_degree, arch.prefetch_distance,
+                  arch.l1d.size ? arch.l1d.line_size : arch.l2.line_size)
+    , console_(&std::cout)
 {
   // create functional units
-  FUs_.at((int)FUType::ALU) = std::make_shared<ALU>(this);
-  FUs_.at((int)FUType::LSU) = std::make_shared<LSU>(this);
-  FUs_.at((int)FUType::BRU) = std::make_shared<BRU>(this);
-  FUs_.at((int)FUType::SFU) = std::make_shared<SFU>(this);
+  for (uint32_t i = 0; i < arch.fu_units[(int)FUType::ALU]; ++i) {
+    FUs_.push_back(std::make_shared<ALU>(this));
+  }
+  for (uint32_t i = 0; i < arch.fu_units[(int)FUType::BRU]; ++i) {
+    FUs_.push_back(std::make_shared<BRU>(this));
+  }
+  for (uint32_t i = 0; i < arch.fu_units[(int)FUType::LSU]; ++i) {
+    FUs_.push_back(std::make_shared<LSU>(this));
+  }
+  for (uint32_t i = 0; i < arch.fu_units[(int)FUType::SFU]; ++i) {
+    FUs_.push_back(std::make_shared<SFU>(this));
+  }
 
   // initialize register file at x0
   reg_file_.at(0) = 0;
@@ -62,7 +95,19 @@ void Core::reset() {
   fetched_instrs_ = 0;
   perf_stats_ = PerfStats();
 
+  bpred_ = BranchPredictor::Create(arch_.bpred, arch_.bpred_budget);
+  bhist_ = BranchHistory();
+  RAS_ = ReturnAddressStack(arch_.ras_size);
+  ITTAGE_ = ITTAGE();
+  BTB_ = BranchTargetBuffer(arch_.btb_size);
+  prefetcher_.reset();
+
+  cdb_rr_index_ = 0;
+
   fetch_stalled_->reset();
+  ifetch_pending_ = false;
+  fetch_tag_ = 0;
+  fetch_ready_ = 0;
   exited_ = false;
 }
 
@@ -78,53 +123,366 @@ void Core::tick() {
   DPN(2, std::flush);
 }
 
+uint64_t Core::idle_cycles() const {
+  // commit or writeback pending
+  if (!ROB_.empty() && ROB_.get_entry(ROB_.head_index()).ready)
+    return 0;
+  if (!CDB_.empty())
+    return 0;
+
+  // front-end can make progress
+  if (!issue_queue_->empty() && !RS_.full(issue_queue_->data().instr->getFUType()) && !ROB_.full()
+   && !this->rename_blocked(*issue_queue_->data().instr))
+    return 0;
+  if (!decode_queue_->empty() && !issue_queue_->full())
+    return 0;
+  uint64_t cycles = UINT64_MAX;
+  if (arch_.timed_memory) {
+    if (!imem_rsp_port.empty() && !decode_queue_->full())
+      return 0;
+    if (!fetch_stalled_->read() && !ifetch_pending_)
+      return 0;
+  } else if (icache_ && ifetch_pending_) {
+    // an instruction cache access counting down its latency
+    if (perf_stats_.cycles < fetch_ready_) {
+      cycles = fetch_ready_ - perf_stats_.cycles;
+    } else if (!fetch_stalled_->read() && !decode_queue_->full()) {
+      return 0;
+    }
+  } else {
+    if (!fetch_stalled_->read() && !decode_queue_->full())
+      return 0;
+  }
+
+  // functional units still counting down their latency
+  for (auto& fu : FUs_) {
+    if (fu->done())
+      return 0;
+    if (!fu->empty()) {
+      cycles = std::min<uint64_t>(cycles, fu->idle_cycles());
+    }
+  }
+
+  // an instruction can be scheduled, now or once a pipelined unit
+  // takes its next operation, execute() ages the units before dispatch
+  uint32_t rs_size = RS_.size();
+  for (uint32_t rs_index = RS_.select(0, rs_size); rs_index < rs_size; rs_index = RS_.select(rs_index + 1, rs_size)) {
+    if (this->order_blocked(rs_index)
+     || this->spec_blocked(*RS_.instr(rs_index), RS_.rob_index(rs_index)))
+      continue;
+    auto type = RS_.type(rs_index);
+    if (this->free_unit(type))
+      return 0;
+    for (auto& fu : FUs_) {
+      if (fu->type() == type) {
+        cycles = std::min<uint64_t>(cycles, fu->busy_cycles());
+      }
+    }
+  }
+
+  return cycles;
+}
+
+void Core::skip(uint64_t cycles) {
+  for (auto& fu : FUs_) {
+    fu->skip(cycles);
+  }
+  // issue would have counted a stall on every skipped cycle
+  if (!issue_queue_->empty()) {
+    auto& instr = *issue_queue_->data().instr;
+    auto type = instr.getFUType();
+    if (RS_.full(type)) {
+      perf_stats_.rs_stalls[(int)type] += cycles;
+    } else if (!ROB_.full()) {
+      // in issue()'s order, a full LSQ is counted before the PRF
+      if (arch_.lsq && LSQ_.full(instr)) {
+        perf_stats_.lsq_stalls += cycles;
+      } else if (this->rename_blocked(instr)) {
+        perf_stats_.prf_stalls += cycles;
+      }
+    }
+  }
+  if (arch_.timed_memory) {
+    if (ifetch_pending_ && imem_rsp_port.empty()) {
+      perf_stats_.fetch_stalls += cycles;
+    }
+  } else if (icache_ && ifetch_pending_ && perf_stats_.cycles < fetch_ready_) {
+    perf_stats_.fetch_stalls += std::min<uint64_t>(cycles, fetch_ready_ - perf_stats_.cycles);
+  }
+  perf_stats_.cycles += cycles;
+}
+
+void Core::save(CheckpointWriter& ckpt) const {
+  ckpt << reg_file_ << PC_;
+  ROB_.save(ckpt);
+  RAT_.save(ckpt);
+  PRF_.save(ckpt);
+  RS_.save(ckpt);
+  ckpt << RST_;
+  CDB_.save(ckpt);
+  ckpt << cdb_rr_index_;
+  LSQ_.save(ckpt);
+  prefetcher_.save(ckpt);
+  for (auto& fu : FUs_) {
+    fu->save(ckpt);
+  }
+  if (bpred_) {
+    bpred_->save(ckpt);
+  }
+  bhist_.save(ckpt);
+  RAS_.save(ckpt);
+  ITTAGE_.save(ckpt);
+  BTB_.save(ckpt);
+  imem_rsp_port.save(ckpt);
+  dmem_rsp_port.save(ckpt);
+  ckpt << ifetch_pending_ << fetch_tag_ << fetch_ready_;
+  ckpt << exited_ << cout_buf_.str() << uuid_ctr_ << perf_stats_ << fetched_instrs_;
+}
+
+void Core::restore(CheckpointReader& ckpt) {
+  ckpt >> reg_file_ >> PC_;
+  ROB_.restore(ckpt);
+  RAT_.restore(ckpt);
+  PRF_.restore(ckpt);
+  RS_.restore(ckpt);
+  ckpt >> RST_;
+  CDB_.restore(ckpt);
+  ckpt >> cdb_rr_index_;
+  LSQ_.restore(ckpt);
+  prefetcher_.restore(ckpt);
+  for (auto& fu : FUs_) {
+    fu->restore(ckpt);
+  }
+  if (bpred_) {
+    bpred_->restore(ckpt);
+  }
+  bhist_.restore(ckpt);
+  RAS_.restore(ckpt);
+  ITTAGE_.restore(ckpt);
+  BTB_.restore(ckpt);
+  imem_rsp_port.restore(ckpt);
+  dmem_rsp_port.restore(ckpt);
+  ckpt >> ifetch_pending_ >> fetch_tag_ >> fetch_ready_;
+  std::string cout_str;
+  ckpt >> exited_ >> cout_str >> uuid_ctr_ >> perf_stats_ >> fetched_instrs_;
+  cout_buf_.str(cout_str);
+  cout_buf_.seekp(0, std::ios_base::end);
+}
+
 void Core::fetch() {
+  if (arch_.timed_memory) {
+    this->timed_fetch();
+    return;
+  }
+  if (icache_) {
+    this->cached_fetch();
+    return;
+  }
+
+  // fetch a group of up to width instructions
+  for (uint32_t i = 0; i < arch_.width; ++i) {
+    if (fetch_stalled_->read() || decode_queue_->full())
+      return;
+
+    // allocate a new uuid
+    uint32_t uuid = uuid_ctr_++;
+
+    // fetch next instruction from memory at PC address
+    uint32_t instr_code = 0;
+    mmu_.read(&instr_code, PC_, sizeof(uint32_t), 0);
+
+    if (!this->advance_fetch(instr_code, uuid))
+      return;
+  }
+}
+
+void Core::timed_fetch() {
+  // drop responses to fetches squashed while in flight
+  while (!imem_rsp_port.empty() && imem_rsp_port.front().tag != fetch_tag_) {
+    imem_rsp_port.pop();
+  }
+
+  // send the next fetch request to the memory model
+  if (!fetch_stalled_->read() && !ifetch_pending_) {
+    imem_req_port.send(MemReq{PC_, false, fetch_tag_, core_id_, uuid_ctr_});
+    ifetch_pending_ = true;
+    return;
+  }
+
+  if (imem_rsp_port.empty()) {
+    perf_stats_.fetch_stalls += ifetch_pending_;
+    return;
+  }
+  if (decode_queue_->full())
+    return;
+
+  DT(3, "Fetch-" << imem_rsp_port.front());
+  imem_rsp_port.pop();
+  ifetch_pending_ = false;
+
+  // the response covers the fetch group, read the instructions now
+  for (uint32_t i = 0; i < arch_.width && !decode_queue_->full(); ++i) {
+    // allocate a new uuid
+    uint32_t uuid = uuid_ctr_++;
+
+    uint32_t instr_code = 0;
+    mmu_.read(&instr_code, PC_, sizeof(uint32_t), 0);
+
+    if (!this->advance_fetch(instr_code, uuid))
+      return;
+  }
+}
+
+void Core::cached_fetch() {
+  // look the fetch block up in the instruction cache
+  if (!ifetch_pending_) {
+    if (fetch_stalled_->read() || decode_queue_->full())
+      return;
+    // a hit in one cycle delivers the group this cycle
+    fetch_ready_ = perf_stats_.cycles + icache_->access(PC_, false) - 1;
+    ifetch_pending_ = true;
+  }
+
+  if (perf_stats_.cycles < fetch_ready_) {
+    ++perf_stats_.fetch_stalls;
+    return;
+  }
   if (fetch_stalled_->read() || decode_queue_->full())
     return;
+  ifetch_pending_ = false;
 
-  // allocate a new uuid
-  uint32_t uuid = uuid_ctr_++;
+  for (uint32_t i = 0; i < arch_.width && !decode_queue_->full(); ++i) {
+    // allocate a new uuid
+    uint32_t uuid = uuid_ctr_++;
 
-  // fetch next instruction from memory at PC address
-  uint32_t instr_code = 0;
-  mmu_.read(&instr_code, PC_, sizeof(uint32_t), 0);
+    uint32_t instr_code = 0;
+    mmu_.read(&instr_code, PC_, sizeof(uint32_t), 0);
 
-  DT(2, "Fetch: instr=0x" << instr_code << ", PC=0x" << std::hex << PC_ << std::dec << " (#" << uuid << ")");
+    if (!this->advance_fetch(instr_code, uuid))
+      return;
+  }
+}
+
+bool Core::advance_fetch(uint32_t instr_code, uint32_t uuid) {
+  DT(2, "Fetch: instr=0x" << std::hex << instr_code << ", PC=0x" << PC_ << std::dec << " (#" << uuid << ")");
+
+  Word next_PC = PC_ + 4;
+  uint32_t history = bhist_.pos();
+
+  if (arch_.speculative()) {
+    // pre-decode the instruction to find branches
+    auto opcode = Opcode(instr_code & 0x7f);
+    uint32_t rd  = (instr_code >> 7) & 0x1f;
+    uint32_t rs1 = (instr_code >> 15) & 0x1f;
+    Word target = 0;
+    switch (opcode) {
+    case Opcode::B: {
+      // redirect on a predicted-taken branch that hits in the BTB
+      bool taken = bpred_->predict(PC_, bhist_, history) && BTB_.lookup(PC_, &target);
+      if (taken) {
+        next_PC = target;
+      }
+      bhist_.push(taken);
+    } break;
+    case Opcode::JAL:
+      if (BTB_.lookup(PC_, &target)) {
+        next_PC = target;
+      }
+      break;
+    case Opcode::JALR:
+      // returns pop the RAS, other indirect jumps ask ITTAGE then the BTB
+      if (is_return(rd, rs1)) {
+        next_PC = RAS_.pop();
+      } else if (ITTAGE_.predict(PC_, bhist_, history, &target)
+              || BTB_.lookup(PC_, &target)) {
+        next_PC = target;
+      }
+      break;
+    default:
+      break;
+    }
+    // calls push their return address
+    if ((opcode == Opcode::JAL || opcode == Opcode::JALR) && is_link(rd)) {
+      RAS_.push(PC_ + 4);
+    }
+    if (opcode == Opcode::B || opcode == Opcode::JAL || opcode == Opcode::JALR) {
+      DT(3, "Predict: target=0x" << std::hex << next_PC << std::dec << " (#" << uuid << ")");
+    }
+  }
 
   // move instruction data to next stage
-  decode_queue_->push({instr_code, PC_, uuid});
+  decode_queue_->push({instr_code, PC_, uuid, next_PC, history, RAS_.top_index(), RAS_.top_value(), perf_stats_.cycles});
 
   // advance program counter
-  PC_ += 4;
+  Word PC = PC_;
+  PC_ = next_PC;
 
   ++fetched_instrs_;
 
-  // This pipeline has no support for branch prediction,
-  // we should all the fetch stage until decode
-  fetch_stalled_->write(true);
+  // Without branch prediction, a fetch group runs on over sequential
+  // instructions, then the fetch stage stalls until decode has seen its
+  // last one, or until the branch or jump ending it resolves
+  if (!arch_.speculative()) {
+    auto opcode = Opcode(instr_code & 0x7f);
+    if (opcode == Opcode::B || opcode == Opcode::JAL || opcode == Opcode::JALR || opcode == Opcode::SYS
+     || (PC_ % (arch_.width * 4)) == 0) {
+      fetch_stalled_->write(true);
+      return false;
+    }
+    return true;
+  }
+
+  // a fetch group ends at a redirect or at the end of the aligned fetch block
+  return (next_PC == PC + 4) && (next_PC % (arch_.width * 4)) != 0;
 }
 
 void Core::decode() {
-  if (decode_queue_->empty() || issue_queue_->full())
-    return;
+  // decode up to width instructions in order
+  for (uint32_t i = 0; i < arch_.width; ++i) {
+    if (decode_queue_->empty() || issue_queue_->full())
+      return;
+
+    auto& id_data = decode_queue_->data();
+
+    // instruction decode
+    auto instr = this->decode(id_data.instr_code, id_data.PC, id_data.uuid);
+    if (!instr) {
+      // a wrong-path fetch or one past the exit may read data,
+      // hold it until squashed
+      bool in_flight = (i != 0) || !ROB_.empty() || !issue_queue_->empty();
+      if (arch_.speculative() && (exited_ || in_flight))
+        return;
+      std::ostringstream oss;
+      oss << std::hex << "invalid instruction 0x" << id_data.instr_code << ", PC=0x" << id_data.PC;
+      throw ProgramFault(oss.str());
+    }
 
-  auto& id_data = decode_queue_->data();
+    instr->setPrediction(id_data.next_PC, id_data.history);
+    instr->setRasState(id_data.ras_top, id_data.ras_value);
+    instr->setFetchCycle(id_data.fetch_cycle);
 
-  // instruction decode
-  auto instr = this->decode(id_data.instr_code, id_data.PC, id_data.uuid);
+    DT(2, "Decode: " << *instr);
 
-  DT(2, "Decode: " << *instr);
+    if (arch_.speculative()) {
+      // fetch runs ahead of branches,
+      // only stop it when exiting program
+      if (instr->getExeFlags().is_exit) {
+        fetch_stalled_->write(true);
+      }
+    } else {
+      // release fetch stage after the last fetched instruction if not a branch
+      // keep fetch stage locked if exiting program
+      if (id_data.uuid + 1 == uuid_ctr_
+       && instr->getBrOp() == BrOp::NONE
+       && !instr->getExeFlags().is_exit) {
+        fetch_stalled_->write(false); // unlock fetch stage
+      }
+    }
 
-  // release fetch stage if not a branch
-  // keep fetch stage locked if exiting program
-  if (instr->getBrOp() == BrOp::NONE
-   && !instr->getExeFlags().is_exit) {
-    fetch_stalled_->write(false); // unlock fetch stage
+    // move instruction data to next stage
+    issue_queue_->push({instr});
+    decode_queue_->pop();
   }
-
-  // move instruction data to next stage
-  issue_queue_->push({instr});
-  decode_queue_->pop();
 }
 
 void Core::dmem_read(void *data, uint64_t addr, uint32_t size) {
@@ -134,6 +492,16 @@ void Core::dmem_read(void *data, uint64_t addr, uint32_t size) {
   DT(2, "Mem Read: addr=0x" << std::hex << addr << ", data=0x" << ByteStream(data, size) << " (size=" << size << ", type=" << type << ")");
 }
 
+void Core::train_prefetcher(Word PC, uint64_t addr) {
+  if (arch_.dprefetch == PrefetchType::NONE)
+    return;
+  prefetcher_.train(PC, addr, &prefetches_);
+  for (auto prefetch_addr : prefetches_) {
+    DT(3, "Prefetch: addr=0x" << std::hex << prefetch_addr << std::dec);
+    dcache_->prefetch(prefetch_addr);
+  }
+}
+
 void Core::dmem_write(const void* data, uint64_t addr, uint32_t size) {
   auto type = get_addr_type(addr);
   __unused (type);
@@ -172,9 +540,9 @@ uint32_t Core::get_csr(uint32_t addr) {
   case VX_CSR_MINSTRET_H: // NumInsts
     return (uint32_t)(perf_stats_.instrs >> 32);
   default:
-    std::cout << std::hex << "Error: invalid CSR read addr=0x" << addr << std::endl;
-    std::abort();
-    return 0;
+    std::ostringstream oss;
+    oss << std::hex << "invalid CSR read addr=0x" << addr;
+    throw ProgramFault(oss.str());
   }
 }
 
@@ -192,8 +560,9 @@ void Core::set_csr(uint32_t addr, uint32_t value) {
   case VX_CSR_MNSTATUS:
     break;
   default: {
-      std::cout << std::hex << "Error: invalid CSR write addr=0x" << addr << ", value=0x" << value << std::endl;
-      std::abort();
+      std::ostringstream oss;
+      oss << std::hex << "invalid CSR write addr=0x" << addr << ", value=0x" << value;
+      throw ProgramFault(oss.str());
     }
   }
 }
@@ -202,21 +571,23 @@ void Core::writeToStdOut(const void* data) {
   char c = *(char*)data;
   cout_buf_ << c;
   if (c == '\n') {
-    std::cout << cout_buf_.str() << std::flush;
+    if (console_) {
+      *console_ << cout_buf_.str() << std::flush;
+    }
     cout_buf_.str("");
   }
 }
 
 void Core::cout_flush() {
   auto str = cout_buf_.str();
-  if (!str.empty()) {
-    std::cout << str << std::endl;
+  if (!str.empty() && console_) {
+    *console_ << str << std::endl;
   }
 }
 
 bool Core::check_exit(Word* exitcode, bool riscv_test) const {
   if (exited_) {
-    Word ec = reg_file_.at(3);
+    Word ec = (arch_.prf_size != 0) ? PRF_.arch_value(3) : reg_file_.at(3);
     if (riscv_test) {
       *exitcode = (1 - ec);
     } else {
@@ -235,6 +606,157 @@ void Core::attach_ram(RAM* ram) {
   mmu_.attach(*ram, 0, 0xFFFFFFFF);
 }
 
+void Core::attach_dcache(CacheSim* cache) {
+  dcache_ = cache;
+}
+
+void Core::attach_icache(CacheSim* cache) {
+  icache_ = cache;
+}
+
+void Core::attach_console(std::ostream* os) {
+  console_ = os;
+}
+
+FunctionalUnit* Core::free_unit(FUType type) const {
+  for (auto& fu : FUs_) {
+    if (fu->type() == type && !fu->busy())
+      return fu.get();
+  }
+  return nullptr;
+}
+
+void Core::retire_branch(const Instr& instr) {
+  // train the predictors on the resolved outcome
+  auto br_op = instr.getBrOp();
+  bool taken = (instr.getNextPC() != instr.getPC() + 4);
+  bool ret = (br_op == BrOp::JALR && is_return(instr.getRd(), instr.getRs1()));
+  if (br_op != BrOp::JAL && br_op != BrOp::JALR) {
+    bpred_->update(instr.getPC(), bhist_, instr.getHistory(), taken);
+  } else if (br_op == BrOp::JALR && !ret) {
+    ITTAGE_.update(instr.getPC(), bhist_, instr.getHistory(), instr.getNextPC());
+  }
+  if (taken) {
+    BTB_.update(instr.getPC(), instr.getNextPC());
+  }
+
+  bool mispredicted = instr.isMispredicted();
+  ++perf_stats_.branches;
+  perf_stats_.mispredicts += mispredicted;
+  if (ret) {
+    ++perf_stats_.returns;
+    perf_stats_.return_mispredicts += mispredicted;
+  } else if (br_op == BrOp::JALR) {
+    ++perf_stats_.indirects;
+    perf_stats_.indirect_mispredicts += mispredicted;
+  }
+}
+
+void Core::squash(int rob_index) {
+  auto instr = ROB_.get_entry(rob_index).instr;
+  DT(2, "Squash: next PC=0x" << std::hex << instr->getNextPC() << std::dec << " (#" << instr->getId() << ")");
+
+  // every instruction younger than the branch is on the wrong path
+  decode_queue_->reset();
+  issue_queue_->reset();
+  if (arch_.prf_size != 0) {
+    for (int i = (rob_index + 1) % ROB_.size(); i != ROB_.tail_index(); i = (i + 1) % ROB_.size()) {
+      auto& entry = ROB_.get_entry(i);
+      if (entry.instr->getExeFlags().use_rd) {
+        PRF_.release(entry.instr->getPhysRd());
+      }
+    }
+  }
+  ROB_.squash(rob_index);
+  for (uint32_t rs_index = RS_.next_valid(0); rs_index < RS_.size(); rs_index = RS_.next_valid(rs_index + 1)) {
+    if (!ROB_.get_entry(RS_.rob_index(rs_index)).valid) {
+      RS_.discard(rs_index);
+    }
+  }
+  for (auto& fu : FUs_) {
+    fu->discard([&](int index) { return !ROB_.get_entry(index).valid; });
+  }
+  LSQ_.squash([&](int index) { return !ROB_.get_entry(index).valid; });
+
+  // rebuild the rename map from the remaining in-flight producers
+  if (arch_.prf_size != 0) {
+    PRF_.rollback();
+  } else {
+    RAT_.flush();
+  }
+  for (uint32_t i = 0, index = ROB_.head_index(); i < ROB_.count(); ++i) {
+    auto& entry = ROB_.get_entry(index);
+    if (entry.instr->getExeFlags().use_rd) {
+      if (arch_.prf_size != 0) {
+        PRF_.rename(entry.instr->getRd(), entry.instr->getPhysRd());
+      } else {
+        RAT_.set(entry.instr->getRd(), index);
+      }
+    }
+    index = (index + 1) % ROB_.size();
+  }
+
+  ++perf_stats_.redirects;
+  perf_stats_.redirect_cycles += perf_stats_.cycles - instr->getFetchCycle();
+  uint64_t in_flight = perf_stats_.instrs + ROB_.count();
+  perf_stats_.squashed += fetched_instrs_ - in_flight;
+  fetched_instrs_ = in_flight;
+
+  // resume the history and the RAS on the resolved path
+  RAS_.restore(instr->getRasTop(), instr->getRasValue());
+  bhist_.restore(instr->getHistory());
+  if (instr->getBrOp() != BrOp::JAL && instr->getBrOp() != BrOp::JALR) {
+    bhist_.push(instr->getNextPC() != instr->getPC() + 4);
+  }
+
+  // redirect fetch, a pending instruction fetch is stale
+  PC_ = instr->getNextPC();
+  fetch_stalled_->write(false);
+  ifetch_pending_ = false;
+  ++fetch_tag_;
+}
+
 void Core::showStats() {
   std::cout << std::dec << "PERF: instrs=" << perf_stats_.instrs << ", cycles=" << perf_stats_.cycles << std::endl;
+  std::cout << "CDB: buses=" << arch_.num_cdbs << ", arbitration=" << arch_.cdb_arb << ", stalls";
+  for (uint32_t i = 0; i < NUM_FUS; ++i) {
+    std::cout << " " << FUType(i) << "=" << perf_stats_.cdb_stalls[i];
+  }
+  std::cout << std::endl;
+  std::cout << "RS: schedulers=" << (arch_.distributed_rs ? "distributed" : "unified")
+            << ", select=" << arch_.rs_select << ", stalls";
+  for (uint32_t i = 0; i < NUM_FUS; ++i) {
+    std::cout << " " << FUType(i) << "=" << perf_stats_.rs_stalls[i];
+  }
+  std::cout << std::endl;
+  if (arch_.lsq) {
+    std::cout << "LSQ: loads=" << arch_.lq_size << ", stores=" << arch_.sq_size
+              << ", forwards=" << perf_stats_.store_forwards
+              << ", stalls=" << perf_stats_.lsq_stalls << std::endl;
+  }
+  if (arch_.timed_memory || icache_) {
+    std::cout << "FETCH: buffer=" << (arch_.fetch_buffer ? arch_.fetch_buffer : arch_.width)
+              << ", starved_cycles=" << perf_stats_.fetch_stalls << std::endl;
+  }
+  if (arch_.prf_size != 0) {
+    std::cout << "PRF: registers=" << arch_.prf_size << ", stalls=" << perf_stats_.prf_stalls << std::endl;
+  }
+  if (arch_.speculative()) {
+    auto branches = perf_stats_.branches;
+    auto mispredicts = perf_stats_.mispredicts;
+    std::cout << "BPRED: type=" << arch_.bpred
+              << ", storage=" << bpred_->storage() << " bits"
+              << ", branches=" << branches
+              << ", mispredicts=" << mispredicts
+              << ", accuracy=" << (branches ? (100.0 * (branches - mispredicts) / branches) : 0) << "%"
+              << ", MPKI=" << (perf_stats_.instrs ? (1000.0 * mispredicts / perf_stats_.instrs) : 0)
+              << ", squashed=" << perf_stats_.squashed
+              << ", avg_penalty=" << (perf_stats_.redirects ? (double(perf_stats_.redirect_cycles) / perf_stats_.redirects) : 0)
+              << std::endl;
+    std::cout << "BPRED: returns=" << perf_stats_.returns
+              << ", return_mispredicts=" << perf_stats_.return_mispredicts
+              << ", indirects=" << perf_stats_.indirects
+              << ", indirect_mispredicts=" << perf_stats_.indirect_mispredicts
+              << std::endl;
+  }
 }
@@ -26,15 +26,23 @@
 #include <mem.h>
 #include "debug.h"
 #include "types.h"
+#include "arch.h"
 #include "val_reg.h"
 #include "fifo_reg.h"
 #include "instr.h"
 #include "RAT.h"
+#include "PRF.h"
 #include "RS.h"
 #include "RST.h"
 #include "ROB.h"
+#include "LSQ.h"
 #include "FU.h"
 #include "CDB.h"
+#include "BTB.h"
+#include "BPU.h"
+#include "RAS.h"
+#include "cache_sim.h"
+#include "prefetcher.h"
 
 namespace tinyrv {
 
@@ -47,34 +55,94 @@ public:
   struct PerfStats {
     uint64_t cycles;
     uint64_t instrs;
+    uint64_t branches;
+    uint64_t mispredicts;
+    uint64_t returns;
+    uint64_t return_mispredicts;
+    uint64_t indirects;
+    uint64_t indirect_mispredicts;
+    uint64_t redirects;       // mispredictions recovered, including wrong-path ones
+    uint64_t redirect_cycles; // fetch-to-redirect cycles of recovered branches
+    uint64_t squashed;        // wrong-path instructions flushed
+    uint64_t cdb_stalls[NUM_FUS]; // cycles a done unit waited for a result bus
+    uint64_t rs_stalls[NUM_FUS];  // cycles issue waited for a scheduler entry
+    uint64_t prf_stalls;      // cycles issue waited for a free physical register
+    uint64_t lsq_stalls;      // cycles issue waited for a load/store queue entry
+    uint64_t store_forwards;  // loads served by an older store
+    uint64_t fetch_stalls;    // cycles fetch waited on instruction memory
 
     PerfStats()
       : cycles(0)
       , instrs(0)
-    {}
+      , branches(0)
+      , mispredicts(0)
+      , returns(0)
+      , return_mispredicts(0)
+      , indirects(0)
+      , indirect_mispredicts(0)
+      , redirects(0)
+      , redirect_cycles(0)
+      , squashed(0)
+      , prf_stalls(0)
+      , lsq_stalls(0)
+      , store_forwards(0)
+      , fetch_stalls(0)
+    {
+      for (uint32_t i = 0; i < NUM_FUS; ++i) {
+        cdb_stalls[i] = 0;
+        rs_stalls[i] = 0;
+      }
+    }
   };
 
-  Core(const SimContext& ctx, uint32_t core_id, ProcessorImpl* processor);
+  SimPort<MemReq> imem_req_port;
+  SimPort<MemRsp> imem_rsp_port;
+
+  SimPort<MemReq> dmem_req_port;
+  SimPort<MemRsp> dmem_rsp_port;
+
+  Core(const SimContext& ctx, uint32_t core_id, ProcessorImpl* processor, const Arch& arch);
   ~Core();
 
   void reset();
 
   void tick();
 
+  uint64_t idle_cycles() const;
+
+  void skip(uint64_t cycles);
+
+  void save(CheckpointWriter& ckpt) const;
+
+  void restore(CheckpointReader& ckpt);
+
   void attach_ram(RAM* ram);
 
+  void attach_dcache(CacheSim* cache);
+
+  void attach_icache(CacheSim* cache);
+
+  // program console output, none drops it
+  void attach_console(std::ostream* os);
+
   bool running() const;
 
   bool check_exit(Word* exitcode, bool riscv_test) const;
 
   void showStats();
 
+  const PerfStats& perf_stats() const {
+    return perf_stats_;
+  }
+
 private:
 
   Instr::Ptr decode(uint32_t instr_code, uint32_t PC, uint64_t uuid) const;
 
   void dmem_read(void* data, uint64_t addr, uint32_t size);
 
+  void train_prefetcher(Word PC, uint64_t addr);
+
   void dmem_write(const void* data, uint64_t addr, uint32_t size);
 
   void set_csr(uint32_t addr, uint32_t value);
@@ -89,12 +157,29 @@ private:
     uint32_t instr_code;
     Word     PC;
     uint64_t uuid;
+    Word     next_PC;     // predicted fetch address
+    uint32_t history;     // branch history at fetch
+    uint32_t ras_top;     // RAS state after fetch
+    uint32_t ras_value;
+    uint64_t fetch_cycle;
   };
 
   struct is_data_t {
     Instr::Ptr instr;
   };
 
+  friend CheckpointWriter& operator<<(CheckpointWriter& ckpt, const is_data_t& data) {
+    return ckpt << data.instr;
+  }
+
+  friend CheckpointReader& operator>>(CheckpointReader& ckpt, is_data_t& data) {
+    return ckpt >> data.instr;
+  }
+
+  // the processor freezes its schedule over these types
+  typedef FiFoReg<id_data_t> DecodeQueue;
+  typedef FiFoReg<is_data_t> IssueQueue;
+
   struct ex_data_t {
     Instr::Ptr instr;
     uint32_t rs1_data;
@@ -102,32 +187,64 @@ private:
   };
 
   void fetch();
+  void timed_fetch();
+  void cached_fetch();
+  bool advance_fetch(uint32_t instr_code, uint32_t uuid);
   void decode();
   void issue();
   void execute();
   void writeback();
   void commit();
 
+  FunctionalUnit* free_unit(FUType type) const;
+  void dispatch(uint32_t rs_index);
+  bool spec_blocked(const Instr& instr, int rob_index) const;
+  bool order_blocked(uint32_t rs_index) const;
+  bool rename_blocked(const Instr& instr) const;
+  uint32_t read_operand(uint32_t reg, int* rs_index) const;
+  void retire_branch(const Instr& instr);
+  void squash(int rob_index);
+
   uint32_t core_id_;
   ProcessorImpl* processor_;
+  Arch arch_;
   MemoryUnit mmu_;
 
   std::vector<Word> reg_file_;
   Word PC_;
 
-  FiFoReg<id_data_t>::Ptr decode_queue_;
-  FiFoReg<is_data_t>::Ptr issue_queue_;
+  DecodeQueue::Ptr decode_queue_;
+  IssueQueue::Ptr issue_queue_;
   ValReg<bool>::Ptr fetch_stalled_;
 
   ReorderBuffer       ROB_;
   RegisterAliasTable  RAT_;
+  PhysicalRegisterFile PRF_;
   ReservationStation  RS_;
   RegisterStatusTable RST_;
   CommonDataBus       CDB_;
+  LoadStoreQueue      LSQ_;
   std::vector<FunctionalUnit::Ptr> FUs_;
+  std::vector<uint32_t> cdb_requests_;
+  std::vector<uint32_t> rs_ready_;
+  uint32_t cdb_rr_index_;
+  BranchPredictor::Ptr bpred_;
+  BranchHistory       bhist_;
+  BranchTargetBuffer  BTB_;
+  ReturnAddressStack  RAS_;
+  ITTAGE              ITTAGE_;
+  CacheSim*           dcache_;
+  CacheSim*           icache_;
+  DataPrefetcher      prefetcher_;
+  std::vector<uint64_t> prefetches_;
   bool exited_;
 
+  bool ifetch_pending_;
+  uint32_t fetch_tag_;
+  uint64_t fetch_ready_;  // cycle the instruction cache access completes
+
   std::stringstream cout_buf_;
+  std::ostream* console_;
 
   uint64_t uuid_ctr_;
 
@@ -138,6 +255,7 @@ private:
   friend class BRU;
   friend class LSU;
   friend class SFU;
+  friend class ProcessorImpl;
 };
 
 } // namespace tinyrv
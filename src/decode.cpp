@@ -211,7 +211,7 @@ Instr::Ptr Core::decode(uint32_t instr_code, uint32_t PC, uint64_t uuid) const {
 
   auto op_it = sc_instTable.find(opcode);
   if (op_it == sc_instTable.end()) {
-    std::cout << std::hex << "Error: invalid opcode: 0x" << static_cast<int>(opcode) << std::endl;
+    // invalid opcode
     return nullptr;
   }
 
@@ -268,8 +268,7 @@ Instr::Ptr Core::decode(uint32_t instr_code, uint32_t PC, uint64_t uuid) const {
     case Opcode::FENCE:
       break;
     default:
-      std::abort();
-      break;
+      return nullptr;
     }
   } break;
   case InstType::S: {
@@ -316,7 +315,7 @@ Instr::Ptr Core::decode(uint32_t instr_code, uint32_t PC, uint64_t uuid) const {
   } break;
 
   default:
-    std::abort();
+    return nullptr;
   }
 
   // prevent write to x0
@@ -391,7 +390,7 @@ Instr::Ptr Core::decode(uint32_t instr_code, uint32_t PC, uint64_t uuid) const {
       break;
     }
     default:
-      std::abort();
+      return nullptr;
     }
     break;
   }
@@ -430,7 +429,7 @@ Instr::Ptr Core::decode(uint32_t instr_code, uint32_t PC, uint64_t uuid) const {
       break;
     }
     default:
-      std::abort();
+      return nullptr;
     }
     break;
   }
@@ -470,7 +469,7 @@ Instr::Ptr Core::decode(uint32_t instr_code, uint32_t PC, uint64_t uuid) const {
       case 0x302: // RV32I: MRET
         break;
       default:
-        std::abort();
+        return nullptr;
       }
     } else {
       exe_flags.is_csr = 1;
@@ -512,7 +511,7 @@ Instr::Ptr Core::decode(uint32_t instr_code, uint32_t PC, uint64_t uuid) const {
         break;
       }
       default:
-        std::abort();
+        return nullptr;
       }
     }
     break;
@@ -522,7 +521,7 @@ Instr::Ptr Core::decode(uint32_t instr_code, uint32_t PC, uint64_t uuid) const {
     break;
   }
   default:
-    std::abort();
+    return nullptr;
   }
 
   // Functional unit type decoding
@@ -0,0 +1,193 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <assert.h>
+#include <util.h>
+#include "debug.h"
+#include "dram_sim.h"
+
+using namespace tinyrv;
+
+DramSim::DramSim(const SimContext& ctx,
+                 const char* name,
+                 uint32_t num_ports,
+                 const DramConfig& config,
+                 uint32_t block_size)
+  : SimObject<DramSim>(ctx, name)
+  , req_ports(num_ports, this)
+  , rsp_ports(num_ports, this)
+  , config_(config)
+  , block_size_(block_size)
+  , tRCD_(this->core_cycles(config.tRCD))
+  , tRP_(this->core_cycles(config.tRP))
+  , tCAS_(this->core_cycles(config.tCAS))
+  , tBURST_(this->core_cycles(config.tBURST))
+  , channels_(config.channels)
+{
+  assert(config.channels != 0 && config.banks != 0);
+  assert(config.queue_size != 0);
+  assert(config.row_size >= block_size && config.row_size % block_size == 0);
+  this->reset();
+}
+
+DramSim::~DramSim() {}
+
+uint32_t DramSim::core_cycles(uint32_t dram_cycles) const {
+  // rounded up, every command takes at least a core cycle
+  int ratio = config_.cycle_ratio;
+  if (ratio > 0)
+    return dram_cycles * ratio;
+  uint32_t divisor = (ratio < 0) ? -ratio : 1;
+  return std::max<uint32_t>((dram_cycles + divisor - 1) / divisor, 1);
+}
+
+void DramSim::reset() {
+  for (auto& channel : channels_) {
+    channel.queue.clear();
+    channel.banks.assign(config_.banks, {false, 0, 0});
+    channel.bus_free = 0;
+  }
+  rr_index_ = 0;
+  perf_stats_ = PerfStats();
+}
+
+void DramSim::tick() {
+  uint64_t now = this->platform().cycles();
+  uint32_t num_ports = req_ports.size();
+  uint32_t blocks_per_row = config_.row_size / block_size_;
+
+  // move arriving requests into their channel queue
+  bool stalled = false;
+  bool accepted = false;
+  for (uint32_t i = 0; i < num_ports; ++i) {
+    auto& req_port = req_ports.at((rr_index_ + i) % num_ports);
+    while (!req_port.empty()) {
+      auto& mem_req = req_port.front();
+      uint64_t block = mem_req.addr / block_size_;
+      auto& channel = channels_.at(block % config_.channels);
+      if (channel.queue.size() == config_.queue_size) {
+        stalled = true;
+        break;
+      }
+      DT(3, this->name() << "-" << mem_req);
+      uint64_t bank_row = block / config_.channels / blocks_per_row;
+      uint32_t bank = bank_row % config_.banks;
+      channel.queue.push_back({mem_req, (rr_index_ + i) % num_ports, req_port.arrival_time(), bank, bank_row / config_.banks});
+      req_port.pop();
+      accepted = true;
+    }
+  }
+  if (accepted) {
+    rr_index_ = (rr_index_ + 1) % num_ports;
+  }
+  perf_stats_.stalls += stalled;
+
+  // FR-FCFS: the oldest row hit to a ready bank, else the oldest request to one
+  for (auto& channel : channels_) {
+    int selected = -1;
+    for (uint32_t i = 0; i < channel.queue.size(); ++i) {
+      auto& request = channel.queue[i];
+      auto& bank = channel.banks.at(request.bank);
+      if (bank.ready > now)
+        continue;
+      if (bank.open && bank.row == request.row) {
+        selected = i;
+        break;
+      }
+      if (selected < 0) {
+        selected = i;
+      }
+    }
+    if (selected >= 0) {
+      this->issue(channel, selected);
+    }
+  }
+}
+
+void DramSim::issue(channel_t& channel, uint32_t index) {
+  uint64_t now = this->platform().cycles();
+  auto request = channel.queue.at(index);
+  auto& bank = channel.banks.at(request.bank);
+
+  // open the row first unless it is already
+  uint64_t column = now;
+  if (bank.open && bank.row == request.row) {
+    ++perf_stats_.row_hits;
+  } else {
+    if (bank.open) {
+      ++perf_stats_.row_conflicts;
+      column += tRP_;
+    } else {
+      ++perf_stats_.row_misses;
+    }
+    column += tRCD_;
+    bank.open = true;
+    bank.row = request.row;
+  }
+
+  // the data waits for the bus, the bank for the transfer
+  uint64_t data = std::max(column + tCAS_, channel.bus_free);
+  channel.bus_free = data + tBURST_;
+  bank.ready = column + tBURST_;
+
+  auto& mem_req = request.req;
+  if (mem_req.write) {
+    ++perf_stats_.writes;
+  } else {
+    ++perf_stats_.reads;
+  }
+  perf_stats_.busy += tBURST_;
+  perf_stats_.latency += channel.bus_free - request.arrival;
+  rsp_ports.at(request.port).send(MemRsp{mem_req.tag, mem_req.cid, mem_req.uuid}, channel.bus_free - now);
+  channel.queue.erase(channel.queue.begin() + index);
+}
+
+uint64_t DramSim::idle_cycles() const {
+  for (auto& req_port : req_ports) {
+    if (!req_port.empty())
+      return 0;
+  }
+  // queued requests wait for their bank
+  uint64_t now = this->platform().cycles();
+  uint64_t cycles = UINT64_MAX;
+  for (auto& channel : channels_) {
+    for (auto& request : channel.queue) {
+      auto& bank = channel.banks.at(request.bank);
+      if (bank.ready <= now)
+        return 0;
+      cycles = std::min(cycles, bank.ready - now);
+    }
+  }
+  return cycles;
+}
+
+void DramSim::save(CheckpointWriter& ckpt) const {
+  for (auto& req_port : req_ports) {
+    req_port.save(ckpt);
+  }
+  for (auto& rsp_port : rsp_ports) {
+    rsp_port.save(ckpt);
+  }
+  ckpt << channels_ << rr_index_ << perf_stats_;
+}
+
+void DramSim::restore(CheckpointReader& ckpt) {
+  for (auto& req_port : req_ports) {
+    req_port.restore(ckpt);
+  }
+  for (auto& rsp_port : rsp_ports) {
+    rsp_port.restore(ckpt);
+  }
+  ckpt >> channels_ >> rr_index_ >> perf_stats_;
+}
@@ -0,0 +1,128 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+#include <simobject.h>
+#include "types.h"
+
+namespace tinyrv {
+
+// DRAM timing model.
+// Blocks are interleaved across channels, then fill a row before moving
+// to the next bank. Each channel queues requests and issues one per cycle
+// in FR-FCFS order: the oldest request hitting an open row first, else
+// the oldest request, both to a bank that is ready. Rows stay open; a row
+// miss activates (tRCD) and a row conflict also precharges (tRP) before
+// the column access (tCAS), then the block takes the channel data bus for
+// tBURST. DRAM timings are scaled to core cycles by the clock ratio.
+class DramSim : public SimObject<DramSim> {
+public:
+  struct PerfStats {
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t row_hits;
+    uint64_t row_misses;    // accesses to a bank with no open row
+    uint64_t row_conflicts; // accesses to a bank with another row open
+    uint64_t latency;       // total cycles from request arrival to response
+    uint64_t busy;          // data bus cycles, summed over channels
+    uint64_t stalls;        // cycles with requests left waiting for a full queue
+
+    PerfStats()
+      : reads(0)
+      , writes(0)
+      , row_hits(0)
+      , row_misses(0)
+      , row_conflicts(0)
+      , latency(0)
+      , busy(0)
+      , stalls(0)
+    {}
+  };
+
+  std::vector<SimPort<MemReq>> req_ports;
+  std::vector<SimPort<MemRsp>> rsp_ports;
+
+  DramSim(const SimContext& ctx,
+          const char* name,
+          uint32_t num_ports,
+          const DramConfig& config,
+          uint32_t block_size);
+
+  ~DramSim();
+
+  void reset();
+
+  void tick();
+
+  uint64_t idle_cycles() const;
+
+  void save(CheckpointWriter& ckpt) const;
+
+  void restore(CheckpointReader& ckpt);
+
+  const DramConfig& config() const {
+    return config_;
+  }
+
+  const PerfStats& perf_stats() const {
+    return perf_stats_;
+  }
+
+private:
+
+  struct request_t {
+    MemReq   req;
+    uint32_t port;
+    uint64_t arrival;
+    uint32_t bank;
+    uint64_t row;
+  };
+
+  struct bank_t {
+    bool     open;
+    uint64_t row;
+    uint64_t ready;   // cycle the bank accepts its next command
+  };
+
+  struct channel_t {
+    std::vector<request_t> queue;
+    std::vector<bank_t> banks;
+    uint64_t bus_free; // cycle the data bus is released
+
+    friend CheckpointWriter& operator<<(CheckpointWriter& ckpt, const channel_t& channel) {
+      return ckpt << channel.queue << channel.banks << channel.bus_free;
+    }
+
+    friend CheckpointReader& operator>>(CheckpointReader& ckpt, channel_t& channel) {
+      return ckpt >> channel.queue >> channel.banks >> channel.bus_free;
+    }
+  };
+
+  uint32_t core_cycles(uint32_t dram_cycles) const;
+
+  void issue(channel_t& channel, uint32_t index);
+
+  DramConfig config_;
+  uint32_t block_size_;
+  uint32_t tRCD_;
+  uint32_t tRP_;
+  uint32_t tCAS_;
+  uint32_t tBURST_;
+  std::vector<channel_t> channels_;
+  uint32_t rr_index_;
+  PerfStats perf_stats_;
+};
+
+}
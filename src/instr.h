@@ -57,6 +57,13 @@ public:
     , func7_(0)
     , alu_op_(AluOp::ADD)
     , exe_flags_(ExeFlags{})
+    , pred_PC_(PC + 4)
+    , next_PC_(PC + 4)
+    , history_(0)
+    , ras_top_(0)
+    , ras_value_(0)
+    , fetch_cycle_(0)
+    , phys_rd_(0)
   {}
 
   void setOpcode(Opcode opcode)  {
@@ -103,6 +110,28 @@ public:
     fu_type_ = value;
   }
 
+  void setPrediction(uint32_t next_PC, uint32_t history) {
+    pred_PC_ = next_PC;
+    history_ = history;
+  }
+
+  void setRasState(uint32_t top, uint32_t value) {
+    ras_top_ = top;
+    ras_value_ = value;
+  }
+
+  void setNextPC(uint32_t value) {
+    next_PC_ = value;
+  }
+
+  void setFetchCycle(uint64_t value) {
+    fetch_cycle_ = value;
+  }
+
+  void setPhysRd(uint32_t value) {
+    phys_rd_ = value;
+  }
+
   uint64_t getId() const { return uuid_; }
   uint32_t getPC() const { return PC_; }
 
@@ -119,6 +148,16 @@ public:
   ExeFlags getExeFlags() const { return exe_flags_; }
   FUType   getFUType() const { return fu_type_; }
 
+  uint32_t getPredPC() const { return pred_PC_; }
+  uint32_t getNextPC() const { return next_PC_; }
+  uint32_t getHistory() const { return history_; }
+  uint32_t getRasTop() const { return ras_top_; }
+  uint32_t getRasValue() const { return ras_value_; }
+  uint64_t getFetchCycle() const { return fetch_cycle_; }
+  uint32_t getPhysRd() const { return phys_rd_; }
+
+  bool isMispredicted() const { return next_PC_ != pred_PC_; }
+
 private:
 
   uint64_t  uuid_;
@@ -137,7 +176,48 @@ private:
   ExeFlags  exe_flags_;
   FUType    fu_type_;
 
+  uint32_t  pred_PC_;     // next PC predicted at fetch
+  uint32_t  next_PC_;     // next PC resolved at execute
+  uint32_t  history_;     // branch history seen at fetch
+  uint32_t  ras_top_;     // RAS state after fetch
+  uint32_t  ras_value_;
+  uint64_t  fetch_cycle_;
+  uint32_t  phys_rd_;     // renamed destination in the merged register file
+
   friend std::ostream &operator<<(std::ostream &, const Instr&);
 };
 
+// pipeline stages share instructions, keep them shared once restored
+inline CheckpointWriter& operator<<(CheckpointWriter& ckpt, const Instr::Ptr& instr) {
+  ckpt << (instr != nullptr);
+  if (instr) {
+    bool first = false;
+    ckpt << ckpt.share_id(instr.get(), &first) << first;
+    if (first) {
+      ckpt << *instr;
+    }
+  }
+  return ckpt;
+}
+
+inline CheckpointReader& operator>>(CheckpointReader& ckpt, Instr::Ptr& instr) {
+  bool present = false;
+  ckpt >> present;
+  instr = nullptr;
+  if (present) {
+    uint64_t id = 0;
+    bool first = false;
+    ckpt >> id >> first;
+    auto& shared = ckpt.shared(id);
+    if (first) {
+      instr = std::make_shared<Instr>(0, 0);
+      ckpt >> *instr;
+      shared = instr;
+    } else {
+      instr = std::static_pointer_cast<Instr>(shared);
+    }
+  }
+  return ckpt;
+}
+
 }
\ No newline at end of file
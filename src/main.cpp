@@ -14,29 +14,238 @@
 #include <iostream>
 #include <iomanip>
 #include <string>
+#include <vector>
 #include <sstream>
 #include <fstream>
 #include <stdlib.h>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <algorithm>
+#include <thread>
 #include <util.h>
 #include "processor.h"
 #include "mem.h"
 #include "core.h"
+#include "arch.h"
+#include "sweep.h"
 
 using namespace tinyrv;
 
 static void show_usage() {
-   std::cout << "Usage: [-g: gshare] [-s: stats] [-h: help] <program>" << std::endl;
+   std::cout << "Usage: [-C <file>: config file] [-O <key>=<value>: config override] [-g: gshare] [-p <none|bimodal|gshare|tage|perceptron>: branch predictor]"
+                " [-b <bytes>: branch predictor budget] [-w <width>: pipeline width]"
+                " [-k <buses>: result buses] [-a <fixed|oldest|rr>: result bus arbitration]"
+                " [-u <alu|bru|lsu|sfu>:<units>[:<interval>]: functional units, several LSUs need -l] [-d: distributed schedulers]"
+                " [-o <index|oldest>: instruction select order] [-P <regs>: merged physical register file]"
+                " [-l: load/store queue]"
+                " [-D <cache>: L1 data cache] [-I <cache>: L1 instruction cache] [-L <cache>: shared L2 cache]"
+                " [-N: L1 instruction cache next-line prefetch] [-F <instrs>: fetch buffer]"
+                " [-x <none|stride|stream>[:<degree>[:<distance>]]: data prefetcher]"
+                " [-f: fast-forward idle cycles] [-t <cycles>: cycle limit] [-m: timed memory] [-M <channels>[:<banks>]: DRAM timed memory] [-s: stats]"
+                " [-c <file>: save checkpoint] [-n <instrs>: checkpoint after instrs]"
+                " [-r <file>: restore checkpoint]"
+                " [-X <key>=<value>[,<value>...]: sweep parameter] [-j <threads>: sweep threads] [-J: sweep JSON output]"
+                " [-h: help] <program>..." << std::endl
+             << "  <cache>: <bytes>[:<ways>[:<line>[:<latency>[:<lru|fifo|random>[:<banks>[:<mshrs>]]]]]]" << std::endl;
 }
 
 bool showStats = false;
+bool fastForward = false;
+uint64_t maxCycles = 0;
+Arch arch;
 const char* program = nullptr;
+const char* ckptSave = nullptr;
+const char* ckptRestore = nullptr;
+uint64_t ckptInstrs = 0;
+std::vector<std::pair<std::string, std::vector<std::string>>> sweepParams;
+std::vector<const char*> sweepPrograms;
+uint32_t sweepThreads = 0;
+bool sweepJson = false;
+
+// set a parameter from a command line option, exits if invalid
+static void set_param(const char* key, const char* value, const char* error) {
+  if (!arch.set(key, value)) {
+    std::cout << "*** error: " << error << " " << value << std::endl;
+    exit(-1);
+  }
+}
 
 static void parse_args(int argc, char **argv) {
+  static const char* const options = "C:O:gp:b:w:k:a:u:do:P:lD:I:L:Nx:F:ft:mM:sc:n:r:X:j:Jh?";
   int c;
-  while ((c = getopt(argc, argv, "gsh?")) != -1) {
+
+  // the config file comes first, options override it
+  opterr = 0;
+  while ((c = getopt(argc, argv, options)) != -1) {
+    if (c == 'C' && !arch.load(optarg))
+      exit(-1);
+  }
+  opterr = 1;
+  optind = 1;
+
+  while ((c = getopt(argc, argv, options)) != -1) {
     switch (c) {
+    case 'C':
+      break;
+    case 'g':
+      arch.bpred = BPredType::GSHARE;
+      break;
+    case 'p':
+      set_param("bpred", optarg, "unknown branch predictor");
+      break;
+    case 'b':
+      set_param("bpred_budget", optarg, "invalid branch predictor budget");
+      break;
+    case 'w':
+      set_param("width", optarg, "invalid pipeline width");
+      break;
+    case 'k':
+      set_param("num_cdbs", optarg, "invalid number of result buses");
+      break;
+    case 'a':
+      set_param("cdb_arb", optarg, "unknown result bus arbitration");
+      break;
+    case 'u': {
+      // several LSUs or a pipelined one need the LSQ, checked once all options are read
+      std::vector<std::string> tokens;
+      std::stringstream ss(optarg);
+      for (std::string token; std::getline(ss, token, ':');) {
+        tokens.push_back(token);
+      }
+      std::string name = tokens.empty() ? "" : tokens[0];
+      int type = -1;
+      if (name == "alu") {
+        type = (int)FUType::ALU;
+      } else if (name == "bru") {
+        type = (int)FUType::BRU;
+      } else if (name == "lsu") {
+        type = (int)FUType::LSU;
+      } else if (name == "sfu") {
+        type = (int)FUType::SFU;
+      }
+      uint32_t units = (tokens.size() > 1) ? strtoul(tokens[1].c_str(), nullptr, 0) : 0;
+      uint32_t interval = (tokens.size() > 2) ? strtoul(tokens[2].c_str(), nullptr, 0) : 1;
+      if (type == -1 || tokens.size() > 3 || units == 0 || interval == 0) {
+        std::cout << "*** error: invalid functional unit configuration " << optarg << std::endl;
+        exit(-1);
+      }
+      arch.fu_units[type] = units;
+      if (tokens.size() > 2) {
+        arch.fu_interval[type] = interval;
+      }
+    } break;
+    case 'd':
+      arch.distributed_rs = true;
+      break;
+    case 'o':
+      set_param("rs_select", optarg, "unknown select order");
+      break;
+    case 'l':
+      arch.lsq = true;
+      break;
+    case 'D':
+      set_param("l1d", optarg, "invalid L1 data cache configuration");
+      break;
+    case 'I':
+      set_param("l1i", optarg, "invalid L1 instruction cache configuration");
+      break;
+    case 'L':
+      set_param("l2", optarg, "invalid L2 cache configuration");
+      break;
+    case 'N':
+      arch.l1i.prefetch = true;
+      break;
+    case 'x': {
+      std::vector<std::string> tokens;
+      std::stringstream ss(optarg);
+      for (std::string token; std::getline(ss, token, ':');) {
+        tokens.push_back(token);
+      }
+      set_param("dprefetch", tokens.empty() ? "" : tokens[0].c_str(), "unknown data prefetcher");
+      if (tokens.size() > 1) {
+        arch.prefetch_degree = strtoul(tokens[1].c_str(), nullptr, 0);
+      }
+      if (tokens.size() > 2) {
+        arch.prefetch_distance = strtoul(tokens[2].c_str(), nullptr, 0);
+      }
+      if (tokens.size() > 3 || arch.prefetch_degree == 0 || arch.prefetch_distance == 0) {
+        std::cout << "*** error: invalid data prefetcher configuration " << optarg << std::endl;
+        exit(-1);
+      }
+    } break;
+    case 'F':
+      set_param("fetch_buffer", optarg, "invalid fetch buffer size");
+      break;
+    case 'P':
+      // the architectural state alone takes NUM_REGS registers
+      if (!arch.set("prf_size", optarg) || arch.prf_size == 0) {
+        std::cout << "*** error: invalid physical register file size " << optarg << ", must exceed " << NUM_REGS << std::endl;
+        exit(-1);
+      }
+      break;
+    case 'm':
+      arch.timed_memory = true;
+      break;
+    case 'M':
+      set_param("dram", optarg, "invalid DRAM configuration");
+      if (arch.dram.channels == 0) {
+        std::cout << "*** error: invalid DRAM configuration " << optarg << std::endl;
+        exit(-1);
+      }
+      break;
+    case 'O': {
+      // key=value, applied after the config file
+      std::string str(optarg);
+      auto pos = str.find('=');
+      if (pos == std::string::npos || !arch.set(str.substr(0, pos), str.substr(pos + 1))) {
+        std::cout << "*** error: invalid parameter " << optarg << std::endl;
+        exit(-1);
+      }
+    } break;
+    case 'c':
+      ckptSave = optarg;
+      break;
+    case 'n':
+      ckptInstrs = strtoull(optarg, nullptr, 0);
+      break;
+    case 'r':
+      ckptRestore = optarg;
+      break;
+    case 'X': {
+      // key=value,value,... swept over every program
+      std::string str(optarg);
+      auto pos = str.find('=');
+      std::vector<std::string> values;
+      std::stringstream ss(pos == std::string::npos ? "" : str.substr(pos + 1));
+      for (std::string value; std::getline(ss, value, ',');) {
+        values.push_back(value);
+      }
+      if (pos == std::string::npos || values.empty()) {
+        std::cerr << "*** error: invalid sweep parameter " << optarg << std::endl;
+        exit(-1);
+      }
+      sweepParams.push_back({str.substr(0, pos), values});
+    } break;
+    case 'j':
+      sweepThreads = strtoul(optarg, nullptr, 0);
+      if (sweepThreads == 0) {
+        std::cerr << "*** error: invalid number of sweep threads " << optarg << std::endl;
+        exit(-1);
+      }
+      break;
+    case 'J':
+      sweepJson = true;
+      break;
+    case 'f':
+      fastForward = true;
+      break;
+    case 't':
+      maxCycles = strtoull(optarg, nullptr, 0);
+      if (maxCycles == 0) {
+        std::cout << "*** error: invalid cycle limit " << optarg << std::endl;
+        exit(-1);
+      }
+      break;
     case 's':
       showStats = true;
       break;
@@ -51,9 +260,31 @@ static void parse_args(int argc, char **argv) {
     }
   }
 
+  if (!arch.check(std::cout))
+    exit(-1);
+
+  // several programs or sweep options select the sweep mode,
+  // its rows are the only output
+  if (!sweepParams.empty() || sweepThreads != 0 || sweepJson || argc - optind > 1) {
+    if (ckptSave || ckptRestore) {
+      std::cerr << "*** error: checkpoints are not supported in sweep mode" << std::endl;
+      exit(-1);
+    }
+    for (int i = optind; i < argc; ++i) {
+      sweepPrograms.push_back(argv[i]);
+    }
+    if (sweepPrograms.empty()) {
+      show_usage();
+      exit(-1);
+    }
+    return;
+  }
+
   if (optind < argc) {
     program = argv[optind];
     std::cout << "Running " << program << ".." << std::endl;
+  } else if (ckptRestore) {
+    std::cout << "Resuming " << ckptRestore << ".." << std::endl;
   } else {
     show_usage();
     exit(-1);
@@ -65,12 +296,31 @@ int main(int argc, char **argv) {
 
   parse_args(argc, argv);
 
+  if (!sweepPrograms.empty()) {
+    Sweep sweep(arch);
+    for (auto& param : sweepParams) {
+      if (!sweep.add_param(param.first, param.second)) {
+        std::cerr << "*** error: invalid sweep parameter " << param.first << std::endl;
+        return -1;
+      }
+    }
+    for (auto program : sweepPrograms) {
+      if (!sweep.add_workload(program)) {
+        std::cerr << "*** error: cannot load workload " << program << std::endl;
+        return -1;
+      }
+    }
+    uint32_t threads = sweepThreads ? sweepThreads : std::max(std::thread::hardware_concurrency(), 1u);
+    auto format = sweepJson ? Sweep::Format::JSON : Sweep::Format::CSV;
+    return sweep.run(threads, format, fastForward, maxCycles, std::cout) ? 0 : -1;
+  }
+
   {
     // create memory module
     RAM ram(RAM_PAGE_SIZE);
 
-    // load program
-    {
+    // load program, a restored checkpoint carries its own memory image
+    if (!ckptRestore) {
       std::string program_ext(fileExtension(program));
       if (program_ext == "bin") {
         ram.loadBinImage(program, STARTUP_ADDR);
@@ -83,14 +333,34 @@ int main(int argc, char **argv) {
     }
 
     // create processor
-    Processor processor;
+    Processor processor(arch);
 
     // attach memory module
     processor.attach_ram(&ram);
 
+    processor.fast_forward(fastForward);
+
+    processor.max_cycles(maxCycles);
+
+    if (ckptRestore) {
+      if (!processor.restore(ckptRestore))
+        return -1;
+    }
+
+    if (ckptSave) {
+      processor.checkpoint(ckptSave, ckptInstrs);
+    }
+
     // run simulation
-    exitcode = processor.run(true);
-    if (exitcode != 0) {
+    try {
+      exitcode = processor.run(true);
+    } catch (const ProgramFault& e) {
+      std::cout << "*** error: " << e.what() << std::endl;
+      exitcode = -1;
+    }
+    if (exitcode == Processor::TIMEOUT) {
+      std::cout << "*** TIMEOUT: no exit after " << maxCycles << " cycles" << std::endl;
+    } else if (exitcode != 0) {
       std::cout << "*** FAILED: exitcode=" << exitcode << std::endl;
     } else {
       std::cout << "PASSED!" << std::endl;
@@ -0,0 +1,111 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <assert.h>
+#include <util.h>
+#include "debug.h"
+#include "mem_sim.h"
+
+using namespace tinyrv;
+
+MemSim::MemSim(const SimContext& ctx,
+               const char* name,
+               uint32_t num_ports,
+               uint32_t latency,
+               uint32_t bandwidth)
+  : SimObject<MemSim>(ctx, name)
+  , req_ports(num_ports, this)
+  , rsp_ports(num_ports, this)
+  , latency_(latency)
+  , bandwidth_(bandwidth)
+  , rr_index_(0) {
+  assert(latency != 0);
+  assert(bandwidth != 0);
+}
+
+MemSim::~MemSim() {}
+
+void MemSim::reset() {
+  rr_index_ = 0;
+  perf_stats_ = PerfStats();
+}
+
+void MemSim::tick() {
+  uint32_t num_ports = req_ports.size();
+  uint32_t served = 0;
+  bool progress = true;
+
+  // serve one request per port in round-robin order until out of bandwidth
+  while (served < bandwidth_ && progress) {
+    progress = false;
+    for (uint32_t i = 0; i < num_ports && served < bandwidth_; ++i) {
+      uint32_t p = (rr_index_ + i) % num_ports;
+      auto& req_port = req_ports.at(p);
+      if (req_port.empty())
+        continue;
+      auto& mem_req = req_port.front();
+      auto arrival = req_port.arrival_time();
+      DT(3, this->name() << "-" << mem_req);
+      rsp_ports.at(p).send(MemRsp{mem_req.tag, mem_req.cid, mem_req.uuid}, latency_);
+      if (mem_req.write) {
+        ++perf_stats_.writes;
+      } else {
+        ++perf_stats_.reads;
+      }
+      perf_stats_.latency += (this->platform().cycles() - arrival) + latency_;
+      req_port.pop();
+      ++served;
+      progress = true;
+    }
+  }
+  if (served != 0) {
+    rr_index_ = (rr_index_ + 1) % num_ports;
+  }
+
+  for (auto& req_port : req_ports) {
+    if (!req_port.empty()) {
+      ++perf_stats_.stalls;
+      break;
+    }
+  }
+}
+
+uint64_t MemSim::idle_cycles() const {
+  for (auto& req_port : req_ports) {
+    if (!req_port.empty())
+      return 0;
+  }
+  // woken up by the next request event
+  return UINT64_MAX;
+}
+
+void MemSim::save(CheckpointWriter& ckpt) const {
+  for (auto& req_port : req_ports) {
+    req_port.save(ckpt);
+  }
+  for (auto& rsp_port : rsp_ports) {
+    rsp_port.save(ckpt);
+  }
+  ckpt << rr_index_ << perf_stats_;
+}
+
+void MemSim::restore(CheckpointReader& ckpt) {
+  for (auto& req_port : req_ports) {
+    req_port.restore(ckpt);
+  }
+  for (auto& rsp_port : rsp_ports) {
+    rsp_port.restore(ckpt);
+  }
+  ckpt >> rr_index_ >> perf_stats_;
+}
@@ -0,0 +1,73 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <simobject.h>
+#include "types.h"
+
+namespace tinyrv {
+
+// Memory-side timing model.
+// Requests arriving on any port compete for a fixed number of service slots
+// per cycle, and each serviced request is answered after a fixed latency.
+// Data is accessed functionally by the requester when the response arrives.
+class MemSim : public SimObject<MemSim> {
+public:
+  struct PerfStats {
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t latency;  // total cycles from request arrival to response
+    uint64_t stalls;   // cycles with requests left waiting for bandwidth
+
+    PerfStats()
+      : reads(0)
+      , writes(0)
+      , latency(0)
+      , stalls(0)
+    {}
+  };
+
+  std::vector<SimPort<MemReq>> req_ports;
+  std::vector<SimPort<MemRsp>> rsp_ports;
+
+  MemSim(const SimContext& ctx,
+         const char* name,
+         uint32_t num_ports,
+         uint32_t latency,
+         uint32_t bandwidth);
+
+  ~MemSim();
+
+  void reset();
+
+  void tick();
+
+  uint64_t idle_cycles() const;
+
+  void save(CheckpointWriter& ckpt) const;
+
+  void restore(CheckpointReader& ckpt);
+
+  const PerfStats& perf_stats() const {
+    return perf_stats_;
+  }
+
+private:
+  uint32_t  latency_;
+  uint32_t  bandwidth_;
+  uint32_t  rr_index_;
+  PerfStats perf_stats_;
+};
+
+}
@@ -13,6 +13,7 @@
 
 #include <iostream>
 #include <iomanip>
+#include <algorithm>
 #include <string.h>
 #include <assert.h>
 #include <util.h>
@@ -24,107 +25,138 @@
 using namespace tinyrv;
 
 void Core::issue() {
-  if (issue_queue_->empty())
-    return;
+  // issue up to width instructions in order, each one renames against
+  // the RAT left by the older ones so dependencies inside the group
+  // resolve to their producers' ROB entries
+  for (uint32_t i = 0; i < arch_.width; ++i) {
+    if (issue_queue_->empty())
+      return;
+
+    auto& is_data = issue_queue_->data();
+    auto instr = is_data.instr;
+    auto exe_flags = instr->getExeFlags();
 
-  auto& is_data = issue_queue_->data();
-  auto instr = is_data.instr;
-  auto exe_flags = instr->getExeFlags();
+    // check for structial hazards
+    // TODO:
+    if (RS_.full(instr->getFUType())) {
+      ++perf_stats_.rs_stalls[(int)instr->getFUType()];
+      return;
+    }
+    // check functional unit is busy
 
-  // check for structial hazards
-  // TODO:
-  if (RS_.full())
-    return;
-  // check functional unit is busy
+    if (ROB_.full())
+      return;
 
-  if (ROB_.full())
-    return;
+    // memory instructions need a load/store queue entry
+    if (arch_.lsq && LSQ_.full(*instr)) {
+      ++perf_stats_.lsq_stalls;
+      return;
+    }
 
+    // a destination needs a free physical register
+    if (this->rename_blocked(*instr)) {
+      ++perf_stats_.prf_stalls;
+      return;
+    }
 
-  uint32_t rs1_data = 0; // rs1 data obtained from register file or ROB
-  uint32_t rs2_data = 0;  // rs2 data obtained from register file or ROB
-  int rs1_rsid = -1;      // reservation station id for rs1 (-1 indicates data is already available)
-  int rs2_rsid = -1;      // reservation station id for rs2 (-1 indicates data is already available)
 
-  auto rs1 = instr->getRs1();
-  auto rs2 = instr->getRs2();
+    uint32_t rs1_data = 0; // rs1 data obtained from register file or ROB
+    uint32_t rs2_data = 0;  // rs2 data obtained from register file or ROB
+    int rs1_rsid = -1;      // reservation station id for rs1 (-1 indicates data is already available)
+    int rs2_rsid = -1;      // reservation station id for rs2 (-1 indicates data is already available)
 
-  // get rs1 data
-  // check the RAT if value is in the registe file
-  // if not in the register file, check data is in the ROB
-  // else set rs1_rsid to the reservation station id producing the data
-  // remember to first check if the instruction actually uses rs1
-  // HINT: should use RAT, ROB, RST, and reg_file_
-  // TODO:
-  if (exe_flags.use_rs1) {
-    if(RAT_.exists(rs1)){
-      auto rob_id = RAT_.get(rs1);
+    auto rs1 = instr->getRs1();
+    auto rs2 = instr->getRs2();
+
+    // get rs1 data
+    // check the RAT if value is in the registe file
+    // if not in the register file, check data is in the ROB
+    // else set rs1_rsid to the reservation station id producing the data
+    // remember to first check if the instruction actually uses rs1
+    // HINT: should use RAT, ROB, RST, and reg_file_
+    // TODO:
+    if (exe_flags.use_rs1) {
+      if (arch_.prf_size != 0) {
+        rs1_data = this->read_operand(rs1, &rs1_rsid);
+      } else if(RAT_.exists(rs1)){
+        auto rob_id = RAT_.get(rs1);
       
-      auto rob_entry = ROB_.get_entry(rob_id);
-      if(rob_entry.ready&&rob_entry.valid){
-        rs1_data = rob_entry.result;
+        auto rob_entry = ROB_.get_entry(rob_id);
+        if(rob_entry.ready&&rob_entry.valid){
+          rs1_data = rob_entry.result;
+        }
+        else{
+          rs1_rsid = RST_[rob_id];
+        }
+        DT(2, "rs1_ROB" << RAT_.get(rs1) << " rs1_data" << rs1_data << " rs1_rsid" << rs1_rsid);
       }
       else{
-        rs1_rsid = RST_[rob_id];
+        rs1_data = reg_file_.at(rs1);
       }
-      DT(2, "rs1_ROB" << RAT_.get(rs1) << " rs1_data" << rs1_data << " rs1_rsid" << rs1_rsid);
     }
-    else{
-      rs1_data = reg_file_.at(rs1);
-    }
-  }
   
 
 
-  // get rs2 data
-  // check the RAT if value is in the registe file
-  // if not in the register file, check data is in the ROB
-  // else set rs1_rsid to the reservation station id producing the data
-  // remember to first check if the instruction actually uses rs2
-  // HINT: should use RAT, ROB, RST, and reg_file_
-  // TODO:
-  if (exe_flags.use_rs2) {
-    if(RAT_.exists(rs2)){
-      auto rob_id = RAT_.get(rs2);
-      auto rob_entry = ROB_.get_entry(rob_id);
-      if(rob_entry.ready&&rob_entry.valid){
-        rs2_data = rob_entry.result;
+    // get rs2 data
+    // check the RAT if value is in the registe file
+    // if not in the register file, check data is in the ROB
+    // else set rs1_rsid to the reservation station id producing the data
+    // remember to first check if the instruction actually uses rs2
+    // HINT: should use RAT, ROB, RST, and reg_file_
+    // TODO:
+    if (exe_flags.use_rs2) {
+      if (arch_.prf_size != 0) {
+        rs2_data = this->read_operand(rs2, &rs2_rsid);
+      } else if(RAT_.exists(rs2)){
+        auto rob_id = RAT_.get(rs2);
+        auto rob_entry = ROB_.get_entry(rob_id);
+        if(rob_entry.ready&&rob_entry.valid){
+          rs2_data = rob_entry.result;
+        }
+        else{
+          rs2_rsid = RST_[rob_id];
+        }
       }
       else{
-        rs2_rsid = RST_[rob_id];
+        rs2_data = reg_file_.at(rs2);
       }
     }
-    else{
-      rs2_data = reg_file_.at(rs2);
-    }
-  }
 
-  // allocat new ROB entry and obtain its index
-  // TODO:
-  auto rob_index = ROB_.allocate(instr);
+    // allocat new ROB entry and obtain its index
+    // TODO:
+    auto rob_index = ROB_.allocate(instr);
+    if (arch_.lsq) {
+      LSQ_.allocate(*instr, rob_index);
+    }
 
-  // update the RAT mapping if this instruction write to the register file
-  // TODO:
-  if(exe_flags.use_rd){
-    RAT_.set(instr->getRd(), rob_index);
-  }
+    // update the RAT mapping if this instruction write to the register file
+    // TODO:
+    // or rename it to a free physical register
+    if(exe_flags.use_rd){
+      if (arch_.prf_size != 0) {
+        instr->setPhysRd(PRF_.allocate(instr->getRd(), rob_index));
+      } else {
+        RAT_.set(instr->getRd(), rob_index);
+      }
+    }
 
-  // issue the instruction to free reservation station
-  // TODO:
-  auto rs_index = RS_.issue(rob_index, rs1_rsid, rs2_rsid, rs1_data, rs2_data, instr);
+    // issue the instruction to free reservation station
+    // TODO:
+    auto rs_index = RS_.issue(rob_index, rs1_rsid, rs2_rsid, rs1_data, rs2_data, instr);
 
-  // update RST mapping
-  // TODO:
-  RST_[rob_index] = rs_index;
+    // update RST mapping
+    // TODO:
+    RST_[rob_index] = rs_index;
 
   
 
 
-  DT(2, "Issue: " << *instr);
-  DT(2,"NOW "<< rob_index << " issued to " << instr->getRd());
+    DT(2, "Issue: " << *instr);
+    DT(2,"NOW "<< rob_index << " issued to " << instr->getRd());
 
-  // pop issue queue
-  issue_queue_->pop();
+    // pop issue queue
+    issue_queue_->pop();
+  }
 }
 
 void Core::execute() {
@@ -133,84 +165,151 @@ void Core::execute() {
     fu->execute();
   }
 
-  // find the next functional units that is done executing
-  // and push its output result to the common data bus
-  // then clear the functional unit.
-  // The CDB can only serve one functional unit per cycle
+  // find the functional units that are done executing
+  // and push their output results to the common data bus
+  // then clear the functional units.
+  // The CDB serves num_cdbs functional units per cycle,
+  // the others hold their result and retry next cycle
   // HINT: should use CDB_ and FUs_
-  for (auto fu : FUs_) {
-    // TODO:
-    if(fu->done()){
-      auto result = fu->get_output();
-      CDB_.push(result.result, result.rob_index, result.rs_index);
-      fu->clear();
-      break;
+  cdb_requests_.clear();
+  for (uint32_t i = 0; i < FUs_.size(); ++i) {
+    if (FUs_[i]->done()) {
+      cdb_requests_.push_back(i);
     }
-
+  }
+  switch (arch_.cdb_arb) {
+  case CDBArbType::FIXED:
+    break;
+  case CDBArbType::OLDEST:
+    std::sort(cdb_requests_.begin(), cdb_requests_.end(), [&](uint32_t a, uint32_t b) {
+      return ROB_.age(FUs_[a]->get_output().rob_index) < ROB_.age(FUs_[b]->get_output().rob_index);
+    });
+    break;
+  case CDBArbType::ROUND_ROBIN: {
+    uint32_t n = FUs_.size();
+    std::sort(cdb_requests_.begin(), cdb_requests_.end(), [&](uint32_t a, uint32_t b) {
+      return ((a + n - cdb_rr_index_) % n) < ((b + n - cdb_rr_index_) % n);
+    });
+  } break;
+  }
+  for (auto i : cdb_requests_) {
+    if (CDB_.full()) {
+      ++perf_stats_.cdb_stalls[(int)FUs_[i]->type()];
+      continue;
+    }
+    auto& fu = FUs_[i];
+    auto result = fu->get_output();
+    CDB_.push(result.result, result.rob_index, result.rs_index);
+    fu->clear();
+    cdb_rr_index_ = (i + 1) % FUs_.size();
   }
 
   // schedule ready instructions to corresponding functional units
-  // iterate through all reservation stations, check if the entry is valid, but not running yet,
-  // and its operands are ready, and also make sure that is not locked (LSU case).
-  // once a candidate is found, issue the instruction to its corresponding functional unit.
+  // select walks the entries that are valid, not running yet and have their
+  // operands ready, in index order or oldest first.
   // HINT: should use RS_ and FUs_
-  for (int rs_index = 0; rs_index < (int)RS_.size(); ++rs_index) {
-    auto& entry = RS_.get_entry(rs_index);
-    // TODO:
-    if(entry.valid && !entry.running && entry.operands_ready() && !RS_.locked(rs_index)){
-      auto fu = FUs_.at((int)entry.instr->getFUType());
-      if(fu->busy()){
-        continue;
+  // each scheduler selects for its own units,
+  // a distributed one is skipped when they are all busy
+  for (auto& part : RS_.partitions()) {
+    if (part.type != FUType::NONE && !this->free_unit(part.type))
+      continue;
+    uint32_t end = part.base + part.size;
+    if (arch_.rs_select == RSSelectType::OLDEST) {
+      rs_ready_.clear();
+      for (uint32_t rs_index = RS_.select(part.base, end); rs_index < end; rs_index = RS_.select(rs_index + 1, end)) {
+        rs_ready_.push_back(rs_index);
+      }
+      std::sort(rs_ready_.begin(), rs_ready_.end(), [&](uint32_t a, uint32_t b) {
+        return ROB_.age(RS_.rob_index(a)) < ROB_.age(RS_.rob_index(b));
+      });
+      for (auto rs_index : rs_ready_) {
+        this->dispatch(rs_index);
+      }
+    } else {
+      for (uint32_t rs_index = RS_.select(part.base, end); rs_index < end; rs_index = RS_.select(rs_index + 1, end)) {
+        this->dispatch(rs_index);
       }
-      fu->issue(entry.instr, entry.rob_index, rs_index,entry.rs1_data , entry.rs2_data);
-      entry.running = true;
     }
   }
 }
 
+void Core::dispatch(uint32_t rs_index) {
+  // issue the instruction to a free unit of its type,
+  // unless memory ordering or speculation holds it
+  if (this->order_blocked(rs_index))
+    return;
+  auto fu = this->free_unit(RS_.type(rs_index));
+  if (!fu)
+    return;
+  auto& instr = RS_.instr(rs_index);
+  if (this->spec_blocked(*instr, RS_.rob_index(rs_index)))
+    return;
+  fu->issue(instr, RS_.rob_index(rs_index), rs_index, RS_.rs1_data(rs_index), RS_.rs2_data(rs_index));
+  RS_.dispatch(rs_index);
+}
+
 void Core::writeback() {
   // CDB broadcast
   if (CDB_.empty())
     return;
 
-  auto& cdb_data = CDB_.data();
+  int squash_index = -1;
 
-  // update all reservation stations waiting for operands
-  // HINT: use RS::entry_t::update_operands()
-  for (int rs_index = 0; rs_index < (int)RS_.size(); ++rs_index) {
-    // TODO:
-    RS_.get_entry(rs_index).update_operands(cdb_data);
+  for (uint32_t i = 0; i < CDB_.size(); ++i) {
+    auto& cdb_data = CDB_.data(i);
 
-  }
+    // update the reservation stations waiting for this result
+    RS_.wakeup(cdb_data);
 
-  // free the RS entry associated with this CDB response
-  // so that it can be used by other instructions
-  // TODO:
-  RS_.release(cdb_data.rs_index);
+    // free the RS entry associated with this CDB response
+    // so that it can be used by other instructions
+    // TODO:
+    RS_.release(cdb_data.rs_index);
 
-  // update ROB
-  // TODO:
-  ROB_.update(cdb_data);
+    // update ROB
+    // TODO:
+    ROB_.update(cdb_data);
 
+    // with a merged register file the result is written once, here
+    auto& rob_entry = ROB_.get_entry(cdb_data.rob_index);
+    if (arch_.prf_size != 0 && rob_entry.instr->getExeFlags().use_rd) {
+      PRF_.write(rob_entry.instr->getPhysRd(), cdb_data.result);
+    }
+
+    // a mispredicted branch squashes the younger wrong-path instructions,
+    // the oldest one wins when several resolve in the same cycle
+    if (arch_.speculative() && rob_entry.instr->getBrOp() != BrOp::NONE
+     && rob_entry.instr->isMispredicted()
+     && (squash_index == -1 || ROB_.age(cdb_data.rob_index) < ROB_.age(squash_index))) {
+      squash_index = cdb_data.rob_index;
+    }
+  }
 
   // clear CDB
   // TODO:
   CDB_.pop();
 
+  if (squash_index != -1) {
+    this->squash(squash_index);
+  }
+
 
   RS_.dump();
 }
 
 void Core::commit() {
-  // commit ROB head entry
-  if (ROB_.empty())
-    return;
+  // commit up to width ready entries from the ROB head
+  for (uint32_t i = 0; i < arch_.width && !exited_; ++i) {
+    if (ROB_.empty())
+      break;
 
-  int head_index = ROB_.head_index();
-  auto& rob_head = ROB_.get_entry(head_index);
+    int head_index = ROB_.head_index();
+    auto& rob_head = ROB_.get_entry(head_index);
+
+    // stop at the first head entry not ready to commit
+    if (!rob_head.ready)
+      break;
 
-  // check if the head entry is ready to commit
-  if (rob_head.ready) {
     auto instr = rob_head.instr;
     auto exe_flags = instr->getExeFlags();
 
@@ -218,16 +317,38 @@ void Core::commit() {
     // (1) update the register file
     // (2) clear the RAT if still pointing to this ROB head
     // TODO:
+    // With a merged register file the value is already in place,
+    // commit only frees the register rd was previously mapped to
     if(exe_flags.use_rd){
-      reg_file_.at(instr->getRd()) = rob_head.result;
-      if(RAT_.exists(instr->getRd())){
-        auto rob_id = RAT_.get(instr->getRd());
-        if(rob_id == head_index){
-          RAT_.clear(instr->getRd());
+      if (arch_.prf_size != 0) {
+        PRF_.commit(instr->getRd(), instr->getPhysRd());
+      } else {
+        reg_file_.at(instr->getRd()) = rob_head.result;
+        if(RAT_.exists(instr->getRd())){
+          auto rob_id = RAT_.get(instr->getRd());
+          if(rob_id == head_index){
+            RAT_.clear(instr->getRd());
+          }
         }
       }
     }
 
+    // the store queue writes memory in program order
+    if (arch_.lsq) {
+      if (exe_flags.is_load) {
+        LSQ_.pop_load();
+      } else if (exe_flags.is_store) {
+        auto& store = LSQ_.store_head();
+        this->dmem_write(&store.data, store.addr, store.size);
+        if (arch_.timed_memory) {
+          dmem_req_port.send(MemReq{store.addr, true, 0, core_id_, instr->getId()});
+        } else if (dcache_) {
+          dcache_->access(store.addr, true);
+        }
+        LSQ_.pop_store();
+      }
+    }
+
     // pop ROB entry
     // TODO:
     ROB_.pop();
@@ -241,7 +362,53 @@ void Core::commit() {
     if (exe_flags.is_exit) {
       exited_ = true;
     }
+
+    // train the branch predictor
+    if (arch_.speculative() && instr->getBrOp() != BrOp::NONE) {
+      this->retire_branch(*instr);
+    }
   }
 
   ROB_.dump();
-}
\ No newline at end of file
+}
+
+bool Core::spec_blocked(const Instr& instr, int rob_index) const {
+  // stores and CSR accesses have side effects,
+  // hold them until no older branch can redirect the program,
+  // a store in the LSQ has none before commit
+  if (!arch_.speculative())
+    return false;
+  auto exe_flags = instr.getExeFlags();
+  bool side_effects = exe_flags.is_csr || (exe_flags.is_store && !arch_.lsq);
+  if (!side_effects)
+    return false;
+  return ROB_.speculative(rob_index);
+}
+
+bool Core::order_blocked(uint32_t rs_index) const {
+  // the LSU barrier serializes memory instructions, with the LSQ
+  // only a load that may depend on an older store has to wait
+  if (!arch_.lsq)
+    return RS_.locked(rs_index);
+  auto& instr = *RS_.instr(rs_index);
+  if (!instr.getExeFlags().is_load)
+    return false;
+  uint32_t mem_addr = RS_.rs1_data(rs_index) + instr.getImm();
+  uint32_t data_bytes = 1 << (instr.getFunc3() & 0x3);
+  uint32_t data = 0;
+  return LSQ_.search(RS_.rob_index(rs_index), mem_addr, data_bytes, &data) == LoadStoreQueue::Match::WAIT;
+}
+
+bool Core::rename_blocked(const Instr& instr) const {
+  return arch_.prf_size != 0 && instr.getExeFlags().use_rd && PRF_.full();
+}
+
+uint32_t Core::read_operand(uint32_t reg, int* rs_index) const {
+  // read a renamed source from the merged register file,
+  // or wait on the RS entry of its producer
+  auto preg = PRF_.map(reg);
+  if (PRF_.ready(preg))
+    return PRF_.read(preg);
+  *rs_index = RST_[PRF_.producer(preg)];
+  return 0;
+}
@@ -0,0 +1,146 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <assert.h>
+#include <util.h>
+#include "debug.h"
+#include "prefetcher.h"
+
+using namespace tinyrv;
+
+// a pattern seen this many times in a row triggers prefetches
+static const uint32_t CONFIDENCE_THRESHOLD = 2;
+static const uint32_t CONFIDENCE_MAX = 3;
+
+DataPrefetcher::DataPrefetcher(PrefetchType type, uint32_t degree, uint32_t distance, uint32_t line_size)
+  : type_(type)
+  , degree_(degree)
+  , distance_(distance)
+  , line_size_(line_size)
+  , strides_(PREFETCH_TABLE_SIZE)
+  , streams_(PREFETCH_STREAMS)
+{
+  assert(line_size != 0);
+  this->reset();
+}
+
+DataPrefetcher::~DataPrefetcher() {
+  //--
+}
+
+void DataPrefetcher::reset() {
+  for (auto& entry : strides_) {
+    entry = {false, 0, 0, 0, 0};
+  }
+  for (auto& entry : streams_) {
+    entry = {false, 0, 0, 0, 0};
+  }
+  stamp_ = 0;
+}
+
+void DataPrefetcher::train(Word PC, uint64_t addr, std::vector<uint64_t>* prefetches) {
+  prefetches->clear();
+  switch (type_) {
+  case PrefetchType::STRIDE:
+    this->train_stride(PC, addr, prefetches);
+    break;
+  case PrefetchType::STREAM:
+    this->train_stream(addr, prefetches);
+    break;
+  default:
+    break;
+  }
+}
+
+void DataPrefetcher::train_stride(Word PC, uint64_t addr, std::vector<uint64_t>* prefetches) {
+  auto& entry = strides_.at((PC >> 2) % strides_.size());
+  if (!entry.valid || entry.tag != PC) {
+    entry = {true, PC, addr, 0, 0};
+    return;
+  }
+  int64_t stride = int64_t(addr - entry.last_addr);
+  if (stride == entry.stride) {
+    entry.confidence = std::min(entry.confidence + 1, CONFIDENCE_MAX);
+  } else {
+    entry.stride = stride;
+    entry.confidence = 0;
+  }
+  entry.last_addr = addr;
+  if (entry.stride == 0 || entry.confidence < CONFIDENCE_THRESHOLD)
+    return;
+
+  // one request per distinct block
+  uint64_t last_line = addr / line_size_;
+  for (uint32_t i = 0; i < degree_; ++i) {
+    uint64_t target = addr + entry.stride * int64_t(distance_ + i);
+    uint64_t line = target / line_size_;
+    if (line == last_line)
+      continue;
+    prefetches->push_back(line * line_size_);
+    last_line = line;
+  }
+}
+
+void DataPrefetcher::train_stream(uint64_t addr, std::vector<uint64_t>* prefetches) {
+  uint64_t line = addr / line_size_;
+
+  // follow the stream the line falls near, else replace the oldest
+  stream_t* stream = nullptr;
+  stream_t* victim = &streams_.front();
+  for (auto& entry : streams_) {
+    if (entry.valid) {
+      uint64_t gap = (line > entry.last_line) ? (line - entry.last_line) : (entry.last_line - line);
+      if (gap <= PREFETCH_STREAM_WINDOW) {
+        stream = &entry;
+        break;
+      }
+    }
+    if (!entry.valid || (victim->valid && entry.stamp < victim->stamp)) {
+      victim = &entry;
+    }
+  }
+  if (!stream) {
+    *victim = {true, line, 0, 0, ++stamp_};
+    return;
+  }
+  stream->stamp = ++stamp_;
+  if (line == stream->last_line)
+    return;
+
+  int direction = (line > stream->last_line) ? 1 : -1;
+  if (direction == stream->direction) {
+    stream->confidence = std::min(stream->confidence + 1, CONFIDENCE_MAX);
+  } else {
+    stream->direction = direction;
+    stream->confidence = 1;
+  }
+  stream->last_line = line;
+  if (stream->confidence < CONFIDENCE_THRESHOLD)
+    return;
+
+  for (uint32_t i = 0; i < degree_; ++i) {
+    uint64_t offset = distance_ + i;
+    if (direction < 0 && offset > line)
+      break;
+    prefetches->push_back((direction > 0 ? (line + offset) : (line - offset)) * line_size_);
+  }
+}
+
+void DataPrefetcher::save(CheckpointWriter& ckpt) const {
+  ckpt << strides_ << streams_ << stamp_;
+}
+
+void DataPrefetcher::restore(CheckpointReader& ckpt) {
+  ckpt >> strides_ >> streams_ >> stamp_;
+}
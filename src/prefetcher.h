@@ -0,0 +1,75 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <vector>
+#include <checkpoint.h>
+#include "types.h"
+
+namespace tinyrv {
+
+// data prefetcher trained on load addresses
+// The stride prefetcher keeps the last address and stride of each load
+// in a PC-indexed table; once a stride repeats it prefetches degree
+// blocks starting distance strides ahead. The stream prefetcher tracks
+// runs of nearby lines going up or down, regardless of the load; once
+// a direction repeats it prefetches degree lines starting distance
+// lines ahead. Both return block addresses, the cache drops the blocks
+// already present or in flight.
+class DataPrefetcher {
+public:
+  DataPrefetcher(PrefetchType type, uint32_t degree, uint32_t distance, uint32_t line_size);
+
+  ~DataPrefetcher();
+
+  void reset();
+
+  void train(Word PC, uint64_t addr, std::vector<uint64_t>* prefetches);
+
+  void save(CheckpointWriter& ckpt) const;
+
+  void restore(CheckpointReader& ckpt);
+
+private:
+
+  struct stride_t {
+    bool     valid;
+    Word     tag;
+    uint64_t last_addr;
+    int64_t  stride;
+    uint32_t confidence;
+  };
+
+  struct stream_t {
+    bool     valid;
+    uint64_t last_line;
+    int      direction;
+    uint32_t confidence;
+    uint64_t stamp;
+  };
+
+  void train_stride(Word PC, uint64_t addr, std::vector<uint64_t>* prefetches);
+
+  void train_stream(uint64_t addr, std::vector<uint64_t>* prefetches);
+
+  PrefetchType type_;
+  uint32_t degree_;
+  uint32_t distance_;
+  uint32_t line_size_;
+  std::vector<stride_t> strides_;
+  std::vector<stream_t> streams_;
+  uint64_t stamp_;
+};
+
+}
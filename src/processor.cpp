@@ -11,24 +11,141 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <fstream>
+#include <string.h>
 #include "processor.h"
 #include "processor_impl.h"
 
 using namespace tinyrv;
 
-ProcessorImpl::ProcessorImpl() {
+namespace {
+
+const char sc_ckpt_magic[8] = {'T', 'R', 'V', 'C', 'K', 'P', 'T', '2'};
+
+void show_cache_stats(const char* name, const CacheSim& cache, bool timed) {
+  auto& config = cache.config();
+  auto& stats = cache.perf_stats();
+  uint64_t accesses = stats.reads + stats.writes;
+  std::cout << std::dec << name << ": size=" << config.size
+            << ", ways=" << config.ways
+            << ", line=" << config.line_size
+            << ", repl=" << config.repl
+            << ", reads=" << stats.reads
+            << ", writes=" << stats.writes
+            << ", misses=" << stats.misses
+            << ", merged=" << stats.merged
+            << ", hit_rate=" << (accesses ? (100.0 * (accesses - stats.misses) / accesses) : 0) << "%"
+            << ", writebacks=" << stats.writebacks;
+  if (config.prefetch || stats.prefetches != 0) {
+    // useful prefetches were accessed, in time or while still being filled
+    uint64_t useful = stats.prefetch_hits + stats.prefetch_late;
+    uint64_t uncovered = stats.misses - stats.prefetch_late;
+    std::cout << ", prefetches=" << stats.prefetches
+              << ", prefetch_hits=" << stats.prefetch_hits
+              << ", prefetch_late=" << stats.prefetch_late
+              << ", accuracy=" << (stats.prefetches ? (100.0 * useful / stats.prefetches) : 0) << "%"
+              << ", coverage=" << ((useful + uncovered) ? (100.0 * useful / (useful + uncovered)) : 0) << "%"
+              << ", timeliness=" << (useful ? (100.0 * stats.prefetch_hits / useful) : 0) << "%";
+  }
+  std::cout << std::endl;
+
+  // banks and MSHRs only constrain timed requests
+  if (!timed || (config.banks == 1 && config.mshrs == 0))
+    return;
+  uint64_t cycles = cache.platform().cycles();
+  std::cout << name << ": banks=" << config.banks << ", utilization";
+  auto& bank_accesses = cache.bank_accesses();
+  for (uint32_t i = 0; i < config.banks; ++i) {
+    std::cout << " " << i << "=" << (cycles ? (100.0 * bank_accesses.at(i) / cycles) : 0) << "%";
+  }
+  std::cout << ", conflicts=" << stats.bank_conflicts
+            << ", mshrs=" << config.mshrs
+            << ", avg_mshrs=" << (cycles ? (double(stats.mshr_occupancy) / cycles) : 0)
+            << ", mshr_stalls=" << stats.mshr_stalls << std::endl;
+}
+
+}
+
+ProcessorImpl::ProcessorImpl(const Arch& arch)
+  : arch_(arch)
+  , ram_(nullptr)
+  , ckpt_instrs_(0)
+  , restored_(false)
+  , max_cycles_(0) {
   // initialize simulator
-  SimPlatform::instance().initialize();
+  platform_.initialize();
 
   // create the core
-  core_ = Core::Create(0, this);
+  core_ = Core::Create(platform_, 0, this, arch);
+
+  // the caches serve the core directly without a memory model,
+  // the L1 misses then look up the L2
+  if (arch.l1d.size != 0) {
+    l1d_ = CacheSim::Create(platform_, "l1d", 1, arch.l1d, arch.mem_latency);
+  }
+  if (arch.l1i.size != 0) {
+    l1i_ = CacheSim::Create(platform_, "l1i", 1, arch.l1i, arch.mem_latency);
+  }
+  if (arch.l2.size != 0) {
+    l2_ = CacheSim::Create(platform_, "l2", 2, arch.l2, arch.mem_latency);
+    for (auto l1 : {l1i_.get(), l1d_.get()}) {
+      if (l1) {
+        l1->set_next_level(l2_.get());
+      }
+    }
+  }
+  core_->attach_icache(l1i_ ? l1i_.get() : l2_.get());
+  core_->attach_dcache(l1d_ ? l1d_.get() : l2_.get());
+
+  // connect instruction (0) and data (1) ports to the memory model,
+  // each goes through its L1 and the L2 when there are
+  if (arch.timed_memory) {
+    uint32_t mem_ports = l2_ ? 1 : 2;
+    std::vector<SimPort<MemReq>>* mem_req_ports;
+    std::vector<SimPort<MemRsp>>* mem_rsp_ports;
+    if (arch.dram.channels != 0) {
+      dram_sim_ = DramSim::Create(platform_, "dram", mem_ports, arch.dram, MEM_BLOCK_SIZE);
+      mem_req_ports = &dram_sim_->req_ports;
+      mem_rsp_ports = &dram_sim_->rsp_ports;
+    } else {
+      mem_sim_ = MemSim::Create(platform_, "mem", mem_ports, arch.mem_latency, arch.mem_bandwidth);
+      mem_req_ports = &mem_sim_->req_ports;
+      mem_rsp_ports = &mem_sim_->rsp_ports;
+    }
+    auto connect = [](SimPort<MemReq>* req_port, SimPort<MemRsp>* rsp_port,
+                      SimPort<MemReq>* next_req_port, SimPort<MemRsp>* next_rsp_port) {
+      req_port->bind(next_req_port);
+      next_rsp_port->bind(rsp_port);
+    };
+    for (uint32_t i = 0; i < 2; ++i) {
+      auto req_port = i ? &core_->dmem_req_port : &core_->imem_req_port;
+      auto rsp_port = i ? &core_->dmem_rsp_port : &core_->imem_rsp_port;
+      auto l1 = i ? l1d_.get() : l1i_.get();
+      if (l1) {
+        connect(req_port, rsp_port, &l1->req_ports.at(0), &l1->rsp_ports.at(0));
+        req_port = &l1->mem_req_port;
+        rsp_port = &l1->mem_rsp_port;
+      }
+      if (l2_) {
+        connect(req_port, rsp_port, &l2_->req_ports.at(i), &l2_->rsp_ports.at(i));
+      } else {
+        connect(req_port, rsp_port, &mem_req_ports->at(i), &mem_rsp_ports->at(i));
+      }
+    }
+    if (l2_) {
+      connect(&l2_->mem_req_port, &l2_->mem_rsp_port, &mem_req_ports->at(0), &mem_rsp_ports->at(0));
+    }
+  }
+
+  // the object graph is complete, tick it type by type in creation order
+  platform_.freeze_typed<Core::DecodeQueue, Core::IssueQueue, ValReg<bool>, Core, CacheSim, DramSim, MemSim>();
 
   this->reset();
 }
 
 ProcessorImpl::~ProcessorImpl() {
   // Terminate simulator
-  SimPlatform::instance().finalize();
+  platform_.finalize();
 }
 
 void ProcessorImpl::reset() {
@@ -36,31 +153,258 @@ void ProcessorImpl::reset() {
 }
 
 void ProcessorImpl::attach_ram(RAM* ram) {
+  ram_ = ram;
   core_->attach_ram(ram);
 }
 
+void ProcessorImpl::attach_console(std::ostream* os) {
+  core_->attach_console(os);
+}
+
 int ProcessorImpl::run(bool riscv_test) {
-  SimPlatform::instance().reset();
-  this->reset();
+  // a restored run resumes where the checkpoint left off
+  if (!restored_) {
+    platform_.reset();
+    this->reset();
+  }
+  restored_ = false;
 
   bool done;
   Word exitcode = 0;
   do {
-    SimPlatform::instance().tick();
+    if (max_cycles_ != 0 && platform_.cycles() >= max_cycles_)
+      return Processor::TIMEOUT;
+    platform_.tick();
     done = core_->check_exit(&exitcode, riscv_test);
+    if (!ckpt_path_.empty()
+     && core_->perf_stats().instrs >= ckpt_instrs_
+     && platform_.pending_events() == 0) {
+      this->save_checkpoint();
+    }
   } while (!done);
 
   return exitcode;
 }
 
+void ProcessorImpl::checkpoint(const char* path, uint64_t instrs) {
+  ckpt_path_ = path;
+  ckpt_instrs_ = instrs;
+}
+
+void ProcessorImpl::save_checkpoint() {
+  assert(ram_ != nullptr);
+  std::ofstream ofs(ckpt_path_, std::ios::binary);
+  if (!ofs) {
+    std::cout << "error: cannot create checkpoint " << ckpt_path_ << std::endl;
+    std::abort();
+  }
+  CheckpointWriter ckpt(ofs);
+  ckpt.write(sc_ckpt_magic, sizeof(sc_ckpt_magic));
+  ckpt << this->ckpt_config();
+  platform_.save(ckpt);
+  ram_->save(ckpt);
+  if (!ckpt.good()) {
+    std::cout << "error: failed writing checkpoint " << ckpt_path_ << std::endl;
+    std::abort();
+  }
+  std::cout << "Checkpoint saved to " << ckpt_path_ << " at cycle " << platform_.cycles() << std::endl;
+  ckpt_path_.clear();
+}
+
+ProcessorImpl::ckpt_config_t ProcessorImpl::ckpt_config() const {
+  ckpt_config_t config;
+  memset(&config, 0, sizeof(config));
+  config.num_regs = NUM_REGS;
+  config.rob_size = arch_.rob_size;
+  config.num_rss = arch_.num_rss;
+  config.num_fus = NUM_FUS;
+  config.ram_page_size = RAM_PAGE_SIZE;
+  config.bpred = arch_.bpred;
+  config.bpred_budget = arch_.bpred_budget;
+  config.width = arch_.width;
+  config.num_cdbs = arch_.num_cdbs;
+  config.cdb_arb = arch_.cdb_arb;
+  config.distributed_rs = arch_.distributed_rs;
+  config.rs_select = arch_.rs_select;
+  config.prf_size = arch_.prf_size;
+  config.lsq = arch_.lsq;
+  config.lq_size = arch_.lq_size;
+  config.sq_size = arch_.sq_size;
+  config.agu_latency = arch_.agu_latency;
+  config.btb_size = arch_.btb_size;
+  config.ras_size = arch_.ras_size;
+  config.l1d = arch_.l1d;
+  config.l1i = arch_.l1i;
+  config.l2 = arch_.l2;
+  config.dprefetch = arch_.dprefetch;
+  config.prefetch_degree = arch_.prefetch_degree;
+  config.prefetch_distance = arch_.prefetch_distance;
+  config.dram = arch_.dram;
+  config.fetch_buffer = arch_.fetch_buffer;
+  for (uint32_t i = 0; i < NUM_FUS; ++i) {
+    config.fu_units[i] = arch_.fu_units[i];
+    config.fu_latency[i] = arch_.fu_latency[i];
+    config.fu_interval[i] = arch_.fu_interval[i];
+    config.rs_size[i] = arch_.distributed_rs ? arch_.rs_size[i] : 0;
+  }
+  config.timed_memory = arch_.timed_memory;
+  config.mem_latency = arch_.mem_latency;
+  config.mem_bandwidth = arch_.mem_bandwidth;
+  return config;
+}
+
+bool ProcessorImpl::ckpt_config_t::operator==(const ckpt_config_t& other) const {
+  for (uint32_t i = 0; i < NUM_FUS; ++i) {
+    if (fu_units[i] != other.fu_units[i]
+     || fu_latency[i] != other.fu_latency[i]
+     || fu_interval[i] != other.fu_interval[i]
+     || rs_size[i] != other.rs_size[i])
+      return false;
+  }
+  return num_regs == other.num_regs
+      && rob_size == other.rob_size
+      && num_rss == other.num_rss
+      && num_fus == other.num_fus
+      && ram_page_size == other.ram_page_size
+      && bpred == other.bpred
+      && bpred_budget == other.bpred_budget
+      && width == other.width
+      && num_cdbs == other.num_cdbs
+      && cdb_arb == other.cdb_arb
+      && distributed_rs == other.distributed_rs
+      && rs_select == other.rs_select
+      && prf_size == other.prf_size
+      && lsq == other.lsq
+      && lq_size == other.lq_size
+      && sq_size == other.sq_size
+      && agu_latency == other.agu_latency
+      && btb_size == other.btb_size
+      && ras_size == other.ras_size
+      && l1d == other.l1d
+      && l1i == other.l1i
+      && l2 == other.l2
+      && dprefetch == other.dprefetch
+      && prefetch_degree == other.prefetch_degree
+      && prefetch_distance == other.prefetch_distance
+      && dram == other.dram
+      && fetch_buffer == other.fetch_buffer
+      && timed_memory == other.timed_memory
+      && mem_latency == other.mem_latency
+      && mem_bandwidth == other.mem_bandwidth;
+}
+
+bool ProcessorImpl::restore(const char* path) {
+  assert(ram_ != nullptr);
+  std::ifstream ifs(path, std::ios::binary);
+  if (!ifs) {
+    std::cout << "error: " << path << " not found" << std::endl;
+    return false;
+  }
+  CheckpointReader ckpt(ifs);
+  char magic[sizeof(sc_ckpt_magic)];
+  ckpt_config_t config;
+  ckpt.read(magic, sizeof(magic));
+  ckpt >> config;
+  if (!ckpt.good() || memcmp(magic, sc_ckpt_magic, sizeof(magic)) != 0) {
+    std::cout << "error: " << path << " is not a checkpoint" << std::endl;
+    return false;
+  }
+  auto expected = this->ckpt_config();
+  if (!(config == expected)) {
+    std::cout << "error: " << path << " was saved with a different configuration" << std::endl;
+    return false;
+  }
+  if (!platform_.restore(ckpt)) {
+    std::cout << "error: " << path << " does not match this processor" << std::endl;
+    return false;
+  }
+  ram_->restore(ckpt);
+  if (!ckpt.good()) {
+    std::cout << "error: " << path << " is truncated" << std::endl;
+    return false;
+  }
+  restored_ = true;
+  return true;
+}
+
+void ProcessorImpl::fast_forward(bool enable) {
+  platform_.fast_forward(enable);
+}
+
+void ProcessorImpl::max_cycles(uint64_t cycles) {
+  max_cycles_ = cycles;
+}
+
 void ProcessorImpl::showStats() {
+  std::cout << "CONFIG: ";
+  arch_.dump(std::cout);
+  std::cout << std::endl;
   core_->showStats();
+  auto sim_stats = platform_.perf_stats();
+  if (l1i_) {
+    show_cache_stats("L1I", *l1i_, arch_.timed_memory);
+  }
+  if (l1d_) {
+    show_cache_stats("L1D", *l1d_, arch_.timed_memory);
+  }
+  if (l2_) {
+    show_cache_stats("L2", *l2_, arch_.timed_memory);
+  }
+  if (mem_sim_) {
+    auto mem_stats = mem_sim_->perf_stats();
+    uint64_t mem_reqs = mem_stats.reads + mem_stats.writes;
+    std::cout << std::dec << "MEM: reads=" << mem_stats.reads
+              << ", writes=" << mem_stats.writes
+              << ", avg_latency=" << (mem_reqs ? (double(mem_stats.latency) / mem_reqs) : 0)
+              << ", stall_cycles=" << mem_stats.stalls << std::endl;
+  }
+  if (dram_sim_) {
+    // bandwidth is measured on the data buses
+    auto& config = dram_sim_->config();
+    auto dram_stats = dram_sim_->perf_stats();
+    uint64_t dram_reqs = dram_stats.reads + dram_stats.writes;
+    uint64_t cycles = platform_.cycles();
+    std::cout << std::dec << "DRAM: channels=" << config.channels
+              << ", banks=" << config.banks
+              << ", reads=" << dram_stats.reads
+              << ", writes=" << dram_stats.writes
+              << ", row_hits=" << dram_stats.row_hits
+              << ", row_misses=" << dram_stats.row_misses
+              << ", row_conflicts=" << dram_stats.row_conflicts
+              << ", row_hit_rate=" << (dram_reqs ? (100.0 * dram_stats.row_hits / dram_reqs) : 0) << "%"
+              << ", avg_latency=" << (dram_reqs ? (double(dram_stats.latency) / dram_reqs) : 0)
+              << ", bandwidth=" << (cycles ? (double(dram_reqs * MEM_BLOCK_SIZE) / cycles) : 0) << "B/cycle"
+              << ", bus_utilization=" << (cycles ? (100.0 * dram_stats.busy / (cycles * config.channels)) : 0) << "%"
+              << ", stall_cycles=" << dram_stats.stalls << std::endl;
+  }
+  std::cout << std::dec << "SIM: events=" << sim_stats.events << ", event_allocs=" << sim_stats.event_allocs << std::endl;
+}
+
+Processor::PerfStats ProcessorImpl::perf_stats() const {
+  auto& core_stats = core_->perf_stats();
+  Processor::PerfStats stats;
+  stats.cycles = core_stats.cycles;
+  stats.instrs = core_stats.instrs;
+  stats.branches = core_stats.branches;
+  stats.mispredicts = core_stats.mispredicts;
+  stats.rs_stalls = 0;
+  stats.cdb_stalls = 0;
+  for (uint32_t i = 0; i < NUM_FUS; ++i) {
+    stats.rs_stalls += core_stats.rs_stalls[i];
+    stats.cdb_stalls += core_stats.cdb_stalls[i];
+  }
+  stats.prf_stalls = core_stats.prf_stalls;
+  stats.lsq_stalls = core_stats.lsq_stalls;
+  stats.fetch_stalls = core_stats.fetch_stalls;
+  stats.l1d_misses = l1d_ ? l1d_->perf_stats().misses : 0;
+  stats.l2_misses = l2_ ? l2_->perf_stats().misses : 0;
+  return stats;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-Processor::Processor()
-  : impl_(new ProcessorImpl())
+Processor::Processor(const Arch& arch)
+  : impl_(new ProcessorImpl(arch))
 {}
 
 Processor::~Processor() {
@@ -71,10 +415,34 @@ void Processor::attach_ram(RAM* mem) {
   impl_->attach_ram(mem);
 }
 
+void Processor::attach_console(std::ostream* os) {
+  impl_->attach_console(os);
+}
+
 int Processor::run(bool riscv_test) {
   return impl_->run(riscv_test);
 }
 
+void Processor::checkpoint(const char* path, uint64_t instrs) {
+  impl_->checkpoint(path, instrs);
+}
+
+bool Processor::restore(const char* path) {
+  return impl_->restore(path);
+}
+
+void Processor::fast_forward(bool enable) {
+  impl_->fast_forward(enable);
+}
+
+void Processor::max_cycles(uint64_t cycles) {
+  impl_->max_cycles(cycles);
+}
+
 void Processor::showStats() {
   impl_->showStats();
+}
+
+Processor::PerfStats Processor::perf_stats() const {
+  return impl_->perf_stats();
 }
\ No newline at end of file
@@ -14,24 +14,76 @@
 #pragma once
 
 #include <stdint.h>
+#include <string>
+#include <iosfwd>
+#include <stdexcept>
 
 namespace tinyrv {
 
 class RAM;
 class ProcessorImpl;
+struct Arch;
+
+// raised by run() when the program does something the core cannot
+// execute, only perf_stats() remains meaningful afterwards
+class ProgramFault : public std::runtime_error {
+public:
+  explicit ProgramFault(const std::string& what)
+    : std::runtime_error(what)
+  {}
+};
 
 class Processor {
 public:
-  Processor();
+  // run() result once the cycle limit is reached, a failing riscv-test
+  // only returns even values
+  static const int TIMEOUT = 124;
+
+  // counters summarizing a run
+  struct PerfStats {
+    uint64_t cycles;
+    uint64_t instrs;
+    uint64_t branches;
+    uint64_t mispredicts;
+    uint64_t rs_stalls;    // summed over the FU types
+    uint64_t cdb_stalls;   // summed over the FU types
+    uint64_t prf_stalls;
+    uint64_t lsq_stalls;
+    uint64_t fetch_stalls;
+    uint64_t l1d_misses;
+    uint64_t l2_misses;
+  };
+
+  Processor(const Arch& arch);
   ~Processor();
 
   void attach_ram(RAM* mem);
 
+  // program console output, std::cout by default, none drops it
+  void attach_console(std::ostream* os);
+
   int run(bool riscv_test);
 
+  // save the full simulation state once the given number of
+  // instructions have committed, then keep running
+  void checkpoint(const char* path, uint64_t instrs);
+
+  // load a saved state, the next run() resumes from it
+  bool restore(const char* path);
+
+  void fast_forward(bool enable);
+
+  // stop run() with TIMEOUT at that cycle, 0 for no limit
+  void max_cycles(uint64_t cycles);
+
   void showStats();
 
+  PerfStats perf_stats() const;
+
 private:
+  Processor(const Processor&) = delete;
+  Processor& operator=(const Processor&) = delete;
+
   ProcessorImpl* impl_;
 };
 
@@ -13,26 +13,100 @@
 
 #pragma once
 
+#include "processor.h"
 #include "core.h"
+#include "mem_sim.h"
+#include "dram_sim.h"
+#include "cache_sim.h"
 
 namespace tinyrv {
 
 class ProcessorImpl {
 public:
 
-  ProcessorImpl();
+  ProcessorImpl(const Arch& arch);
   ~ProcessorImpl();
 
   void attach_ram(RAM* mem);
 
+  void attach_console(std::ostream* os);
+
   int run(bool riscv_test);
 
+  void fast_forward(bool enable);
+
+  void max_cycles(uint64_t cycles);
+
+  void checkpoint(const char* path, uint64_t instrs);
+
+  bool restore(const char* path);
+
   void showStats();
 
+  Processor::PerfStats perf_stats() const;
+
 private:
   void reset();
 
+  // parameters a checkpoint is only valid for
+  struct ckpt_config_t {
+    uint32_t num_regs;
+    uint32_t rob_size;
+    uint32_t num_rss;
+    uint32_t num_fus;
+    uint32_t ram_page_size;
+    BPredType bpred;
+    uint32_t bpred_budget;
+    uint32_t width;
+    uint32_t num_cdbs;
+    CDBArbType cdb_arb;
+    uint32_t fu_units[NUM_FUS];
+    uint32_t fu_latency[NUM_FUS];
+    uint32_t fu_interval[NUM_FUS];
+    bool     distributed_rs;
+    uint32_t rs_size[NUM_FUS];
+    RSSelectType rs_select;
+    uint32_t prf_size;
+    bool     lsq;
+    uint32_t lq_size;
+    uint32_t sq_size;
+    uint32_t agu_latency;
+    uint32_t btb_size;
+    uint32_t ras_size;
+    CacheConfig l1d;
+    CacheConfig l1i;
+    CacheConfig l2;
+    PrefetchType dprefetch;
+    uint32_t prefetch_degree;
+    uint32_t prefetch_distance;
+    DramConfig dram;
+    uint32_t fetch_buffer;
+    bool     timed_memory;
+    uint32_t mem_latency;
+    uint32_t mem_bandwidth;
+
+    // field by field, the padding is not part of the configuration
+    bool operator==(const ckpt_config_t& other) const;
+  };
+
+  ckpt_config_t ckpt_config() const;
+
+  void save_checkpoint();
+
+  Arch arch_;
+  SimPlatform platform_;
   Core::Ptr core_;
+  MemSim::Ptr mem_sim_;
+  DramSim::Ptr dram_sim_;
+  CacheSim::Ptr l1d_;
+  CacheSim::Ptr l1i_;
+  CacheSim::Ptr l2_;
+  RAM* ram_;
+
+  std::string ckpt_path_;
+  uint64_t ckpt_instrs_;
+  bool restored_;
+  uint64_t max_cycles_;
 };
 
 }
@@ -0,0 +1,258 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <util.h>
+#include <mem.h>
+#include "processor.h"
+#include "sweep.h"
+
+using namespace tinyrv;
+
+namespace {
+
+const char* const sc_stat_names[] = {
+  "status", "exitcode", "cycles", "instrs", "ipc", "branches", "mispredicts",
+  "rs_stalls", "cdb_stalls", "prf_stalls", "lsq_stalls", "fetch_stalls",
+  "l1d_misses", "l2_misses"
+};
+
+const uint32_t NUM_STATS = sizeof(sc_stat_names) / sizeof(sc_stat_names[0]);
+
+bool is_number(const std::string& str) {
+  return !str.empty() && str.find_first_not_of("0123456789") == std::string::npos;
+}
+
+std::string csv_field(const std::string& str) {
+  if (str.find_first_of(",\"\n") == std::string::npos)
+    return str;
+  std::string out("\"");
+  for (auto c : str) {
+    if (c == '"') {
+      out += '"';
+    }
+    out += c;
+  }
+  return out + "\"";
+}
+
+std::string json_value(const std::string& str) {
+  if (is_number(str))
+    return str;
+  std::string out("\"");
+  for (auto c : str) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+    }
+    out += c;
+  }
+  return out + "\"";
+}
+
+}
+
+Sweep::Sweep(const Arch& base)
+  : base_(base)
+{}
+
+Sweep::~Sweep() {}
+
+bool Sweep::add_param(const std::string& key, const std::vector<std::string>& values) {
+  if (values.empty())
+    return false;
+  for (auto& value : values) {
+    Arch arch(base_);
+    if (!arch.set(key, value))
+      return false;
+  }
+  params_.push_back({key, values});
+  return true;
+}
+
+bool Sweep::add_workload(const char* path) {
+  // the image loaders abort on a missing file
+  if (!std::ifstream(path)) {
+    std::cerr << "error: " << path << " not found" << std::endl;
+    return false;
+  }
+  RAM ram(RAM_PAGE_SIZE);
+  std::string ext(fileExtension(path));
+  if (ext == "bin") {
+    ram.loadBinImage(path, STARTUP_ADDR);
+  } else if (ext == "hex") {
+    ram.loadHexImage(path);
+  } else {
+    std::cerr << "error: " << path << " is not a *.bin or *.hex image" << std::endl;
+    return false;
+  }
+  std::ostringstream oss;
+  CheckpointWriter ckpt(oss);
+  ram.save(ckpt);
+  workloads_.push_back({path, oss.str()});
+  return true;
+}
+
+uint64_t Sweep::num_runs() const {
+  uint64_t num_points = 1;
+  for (auto& param : params_) {
+    num_points *= param.values.size();
+  }
+  return num_points * workloads_.size();
+}
+
+bool Sweep::run(uint32_t num_threads, Format format, bool fast_forward, uint64_t max_cycles, std::ostream& os) {
+  // design points in nested loop order, the last parameter varying fastest
+  uint64_t num_runs = this->num_runs();
+  uint64_t num_points = workloads_.empty() ? 0 : (num_runs / workloads_.size());
+  std::vector<Arch> points;
+  std::vector<std::vector<std::string>> point_values;
+  for (uint64_t i = 0; i < num_points; ++i) {
+    std::vector<std::string> values(params_.size());
+    uint64_t index = i;
+    for (uint32_t j = params_.size(); j-- > 0;) {
+      auto& param = params_.at(j);
+      values.at(j) = param.values.at(index % param.values.size());
+      index /= param.values.size();
+    }
+    Arch arch(base_);
+    for (uint32_t j = 0; j < params_.size(); ++j) {
+      arch.set(params_.at(j).key, values.at(j));
+    }
+    if (!arch.check(std::cerr)) {
+      std::cerr << "error: invalid design point";
+      for (uint32_t j = 0; j < params_.size(); ++j) {
+        std::cerr << (j ? ", " : " ") << params_.at(j).key << "=" << values.at(j);
+      }
+      std::cerr << std::endl;
+      return false;
+    }
+    points.push_back(arch);
+    point_values.push_back(values);
+  }
+
+  if (format == Format::CSV) {
+    os << "workload";
+    for (auto& param : params_) {
+      os << "," << csv_field(param.key);
+    }
+    for (auto name : sc_stat_names) {
+      os << "," << name;
+    }
+    os << std::endl;
+  }
+
+  // rows are printed in run order as soon as the earlier ones are done
+  std::vector<std::string> rows(num_runs);
+  std::vector<bool> done(num_runs, false);
+  uint64_t next_row = 0;
+  std::atomic<uint64_t> next_run(0);
+  std::mutex mutex;
+
+  auto worker = [&]() {
+    for (uint64_t i; (i = next_run++) < num_runs;) {
+      uint64_t point = i / workloads_.size();
+      auto& workload = workloads_.at(i % workloads_.size());
+
+      RAM ram(RAM_PAGE_SIZE);
+      std::istringstream iss(workload.image);
+      CheckpointReader ckpt(iss);
+      ram.restore(ckpt);
+
+      Processor processor(points.at(point));
+      processor.attach_ram(&ram);
+      processor.attach_console(nullptr);
+      processor.fast_forward(fast_forward);
+      processor.max_cycles(max_cycles);
+
+      // a faulting run is reported in its row, the other runs go on
+      auto& values = point_values.at(point);
+      int exitcode = -1;
+      const char* status = "error";
+      std::string fault;
+      try {
+        exitcode = processor.run(true);
+        status = (exitcode == Processor::TIMEOUT) ? "timeout" : (exitcode ? "failed" : "passed");
+      } catch (const std::exception& e) {
+        fault = e.what();
+      } catch (...) {
+        fault = "simulation failed";
+      }
+      if (!fault.empty()) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::cerr << "error: " << workload.path;
+        for (uint32_t j = 0; j < params_.size(); ++j) {
+          std::cerr << ", " << params_.at(j).key << "=" << values.at(j);
+        }
+        std::cerr << ": " << fault << std::endl;
+      }
+      auto stats = processor.perf_stats();
+
+      std::ostringstream ipc;
+      ipc << (stats.cycles ? (double(stats.instrs) / stats.cycles) : 0);
+      std::string stat_values[] = {
+        status, std::to_string(exitcode), std::to_string(stats.cycles), std::to_string(stats.instrs),
+        ipc.str(), std::to_string(stats.branches), std::to_string(stats.mispredicts),
+        std::to_string(stats.rs_stalls), std::to_string(stats.cdb_stalls),
+        std::to_string(stats.prf_stalls), std::to_string(stats.lsq_stalls),
+        std::to_string(stats.fetch_stalls), std::to_string(stats.l1d_misses),
+        std::to_string(stats.l2_misses)
+      };
+
+      std::ostringstream row;
+      if (format == Format::CSV) {
+        row << csv_field(workload.path);
+        for (auto& value : values) {
+          row << "," << csv_field(value);
+        }
+        for (auto& value : stat_values) {
+          row << "," << value;
+        }
+      } else {
+        row << "{\"workload\": " << json_value(workload.path);
+        for (uint32_t j = 0; j < values.size(); ++j) {
+          row << ", " << json_value(params_.at(j).key) << ": " << json_value(values.at(j));
+        }
+        row << ", \"" << sc_stat_names[0] << "\": \"" << status << "\"";
+        for (uint32_t j = 1; j < NUM_STATS; ++j) {
+          row << ", \"" << sc_stat_names[j] << "\": " << stat_values[j];
+        }
+        row << "}";
+      }
+      row << "\n";
+
+      std::lock_guard<std::mutex> lock(mutex);
+      rows.at(i) = row.str();
+      done.at(i) = true;
+      while (next_row < num_runs && done.at(next_row)) {
+        os << rows.at(next_row);
+        rows.at(next_row).clear();
+        ++next_row;
+      }
+      os.flush();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (uint32_t i = 0; i < num_threads && i < num_runs; ++i) {
+    threads.emplace_back(worker);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return true;
+}
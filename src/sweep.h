@@ -0,0 +1,70 @@
+// Copyright 2025 Blaise Tine
+//
+// Licensed under the Apache License;
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <iosfwd>
+#include "arch.h"
+
+namespace tinyrv {
+
+// design-space sweep
+// Runs every workload on every combination of the swept parameter values,
+// the other parameters coming from the base configuration. Each workload
+// image is loaded once and copied into a fresh memory for each run. Runs
+// are spread over a pool of host threads, each simulating one processor
+// at a time, and produce one CSV or JSON line in sweep order.
+class Sweep {
+public:
+  enum class Format {
+    CSV,
+    JSON  // one object per line
+  };
+
+  Sweep(const Arch& base);
+
+  ~Sweep();
+
+  // a swept parameter, false if a value is invalid
+  bool add_param(const std::string& key, const std::vector<std::string>& values);
+
+  // a *.bin or *.hex program, false if missing or unsupported
+  bool add_workload(const char* path);
+
+  // design points times workloads
+  uint64_t num_runs() const;
+
+  // false if a design point is invalid; a run that faults or reaches
+  // max_cycles (0 for no limit) still produces its row, with a status
+  bool run(uint32_t num_threads, Format format, bool fast_forward, uint64_t max_cycles, std::ostream& os);
+
+private:
+
+  struct param_t {
+    std::string key;
+    std::vector<std::string> values;
+  };
+
+  struct workload_t {
+    std::string path;
+    std::string image; // memory contents, in checkpoint format
+  };
+
+  Arch base_;
+  std::vector<param_t> params_;
+  std::vector<workload_t> workloads_;
+};
+
+}
@@ -174,10 +174,181 @@ inline std::ostream &operator<<(std::ostream &os, const FUType& type) {
   return os;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+enum class BPredType {
+  NONE,
+  BIMODAL,
+  GSHARE,
+  TAGE,
+  PERCEPTRON
+};
+
+inline std::ostream &operator<<(std::ostream &os, const BPredType& type) {
+  switch (type) {
+  case BPredType::NONE:       os << "none"; break;
+  case BPredType::BIMODAL:    os << "bimodal"; break;
+  case BPredType::GSHARE:     os << "gshare"; break;
+  case BPredType::TAGE:       os << "tage"; break;
+  case BPredType::PERCEPTRON: os << "perceptron"; break;
+  default: assert(false);
+  }
+  return os;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum class CDBArbType {
+  FIXED,        // functional unit order
+  OLDEST,       // oldest ROB entry first
+  ROUND_ROBIN
+};
+
+inline std::ostream &operator<<(std::ostream &os, const CDBArbType& type) {
+  switch (type) {
+  case CDBArbType::FIXED:       os << "fixed"; break;
+  case CDBArbType::OLDEST:      os << "oldest"; break;
+  case CDBArbType::ROUND_ROBIN: os << "rr"; break;
+  default: assert(false);
+  }
+  return os;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum class RSSelectType {
+  INDEX,        // lowest reservation station index
+  OLDEST        // oldest ROB entry first
+};
+
+inline std::ostream &operator<<(std::ostream &os, const RSSelectType& type) {
+  switch (type) {
+  case RSSelectType::INDEX:  os << "index"; break;
+  case RSSelectType::OLDEST: os << "oldest"; break;
+  default: assert(false);
+  }
+  return os;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum class ReplPolicy {
+  LRU,
+  FIFO,
+  RANDOM
+};
+
+inline std::ostream &operator<<(std::ostream &os, const ReplPolicy& policy) {
+  switch (policy) {
+  case ReplPolicy::LRU:    os << "lru"; break;
+  case ReplPolicy::FIFO:   os << "fifo"; break;
+  case ReplPolicy::RANDOM: os << "random"; break;
+  default: assert(false);
+  }
+  return os;
+}
+
+enum class PrefetchType {
+  NONE,
+  STRIDE,       // per-load constant stride
+  STREAM        // ascending or descending runs of lines
+};
+
+inline std::ostream &operator<<(std::ostream &os, const PrefetchType& type) {
+  switch (type) {
+  case PrefetchType::NONE:   os << "none"; break;
+  case PrefetchType::STRIDE: os << "stride"; break;
+  case PrefetchType::STREAM: os << "stream"; break;
+  default: assert(false);
+  }
+  return os;
+}
+
+// cache geometry and timing, a zero size disables the cache
+struct CacheConfig {
+  uint32_t   size;       // capacity (bytes)
+  uint32_t   ways;       // associativity
+  uint32_t   line_size;  // line size (bytes)
+  uint32_t   latency;    // hit latency (cycles)
+  ReplPolicy repl;
+  bool       prefetch;   // next-line prefetch
+  uint32_t   banks;      // line-interleaved banks, one lookup each per cycle
+  uint32_t   mshrs;      // line fills in flight, 0 for no limit
+};
+
+inline bool operator==(const CacheConfig& a, const CacheConfig& b) {
+  return a.size == b.size
+      && a.ways == b.ways
+      && a.line_size == b.line_size
+      && a.latency == b.latency
+      && a.repl == b.repl
+      && a.prefetch == b.prefetch
+      && a.banks == b.banks
+      && a.mshrs == b.mshrs;
+}
+
+// DRAM organization and timing, zero channels selects the fixed-latency memory
+struct DramConfig {
+  uint32_t channels;
+  uint32_t banks;       // banks per channel
+  uint32_t row_size;    // row buffer (bytes)
+  uint32_t tRCD;        // activate to column command (DRAM clocks)
+  uint32_t tRP;         // precharge (DRAM clocks)
+  uint32_t tCAS;        // column command to data (DRAM clocks)
+  uint32_t tBURST;      // data transfer of a block (DRAM clocks)
+  uint32_t queue_size;  // requests buffered per channel
+  int      cycle_ratio; // core cycles per DRAM clock, negative for a faster DRAM
+};
+
+inline bool operator==(const DramConfig& a, const DramConfig& b) {
+  return a.channels == b.channels
+      && a.banks == b.banks
+      && a.row_size == b.row_size
+      && a.tRCD == b.tRCD
+      && a.tRP == b.tRP
+      && a.tCAS == b.tCAS
+      && a.tBURST == b.tBURST
+      && a.queue_size == b.queue_size
+      && a.cycle_ratio == b.cycle_ratio;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct MemReq {
+  uint64_t addr;
+  bool     write;
+  uint32_t tag;   // requester-defined tag returned with the response
+  uint32_t cid;   // requesting core
+  uint64_t uuid;  // instruction id
+};
+
+inline std::ostream &operator<<(std::ostream &os, const MemReq& req) {
+  os << "mem-" << (req.write ? "wr" : "rd") << ": ";
+  os << "addr=0x" << std::hex << req.addr << std::dec;
+  os << ", tag=" << req.tag;
+  os << ", cid=" << req.cid;
+  os << " (#" << req.uuid << ")";
+  return os;
+}
+
+struct MemRsp {
+  uint32_t tag;
+  uint32_t cid;
+  uint64_t uuid;
+};
+
+inline std::ostream &operator<<(std::ostream &os, const MemRsp& rsp) {
+  os << "mem-rsp: tag=" << rsp.tag;
+  os << ", cid=" << rsp.cid;
+  os << " (#" << rsp.uuid << ")";
+  return os;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 class TicketBarrier  {
 public:
   TicketBarrier () : tick_(0), tock_(0) {}
-  ~TicketBarrier () {}
 
   bool ready(uint32_t id) const {
     return tock_ == id;
@@ -185,6 +356,8 @@ public:
 
   uint32_t tick() { return tick_++; }
 
+  uint32_t untick() { return --tick_; }
+
   uint32_t tock() { return tock_++; }
 
 private: